@@ -0,0 +1,81 @@
+/**********************************************************************
+File name: adaptors.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include "sig11/adaptors.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+
+static const int emits = 10000000;
+
+
+template <typename source_t>
+static void measure(const std::string &name, source_t &source, const long &sum)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < emits; ++i) {
+        source(static_cast<double>(i % 100) * 0.25);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0);
+    std::cout << name << ": "
+              << static_cast<double>(elapsed.count()) / emits << " ns/emit"
+              << " (checksum " << sum << ")"
+              << std::endl;
+}
+
+
+int main()
+{
+    std::cout << emits << " emissions through filter and transform" << std::endl;
+
+    {
+        long sum = 0;
+        sig11::signal<void(double)> prices;
+        sig11::signal<void(double)> expensive;
+        sig11::signal<void(long)> cents;
+        prices.connect([&expensive](double price){
+            if (price > 10.0) {
+                expensive(price);
+            }
+        });
+        expensive.connect([&cents](double price){
+            cents(static_cast<long>(price * 100));
+        });
+        cents.connect([&sum](long value){ sum += value; });
+        measure("intermediate signals", prices, sum);
+    }
+    {
+        long sum = 0;
+        sig11::signal<void(double)> prices;
+        auto guard(sig11::connect(
+                       prices
+                       | sig11::filter([](double price){ return price > 10.0; })
+                       | sig11::transform([](double price){ return static_cast<long>(price * 100); }),
+                       [&sum](long value){ sum += value; }));
+        measure("fused pipeline      ", prices, sum);
+    }
+    return 0;
+}
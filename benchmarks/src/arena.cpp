@@ -0,0 +1,91 @@
+/**********************************************************************
+File name: arena.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include "sig11/sig11.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <memory>
+
+
+static const int cycles = 200000;
+static const int receivers = 3;
+static const int rounds = 5;
+
+
+template <typename make_signal_t>
+static double run_cycles(make_signal_t &&make_signal)
+{
+    volatile int sink = 0;
+    std::array<char, 48> payload{};
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < cycles; ++i) {
+        auto signal = make_signal();
+        for (int j = 0; j < receivers; ++j) {
+            signal->connect([&sink, payload](int value){ sink = value + payload[0]; });
+        }
+        (*signal)(i);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / cycles;
+}
+
+
+int main()
+{
+    using signal_t = sig11::signal<void(int)>;
+
+    sig11::slot_arena arena;
+    sig11::slot_arena local_arena(sig11::slot_arena::single_threaded);
+
+    auto make_heap = [](){ return std::unique_ptr<signal_t>(new signal_t()); };
+    auto make_pooled = [&arena](){ return std::unique_ptr<signal_t>(new signal_t(arena)); };
+    auto make_local = [&local_arena](){ return std::unique_ptr<signal_t>(new signal_t(local_arena)); };
+
+    // warm up both the global allocator and the arenas
+    run_cycles(make_heap);
+    run_cycles(make_pooled);
+    run_cycles(make_local);
+
+    double heap = std::numeric_limits<double>::max();
+    double pooled = std::numeric_limits<double>::max();
+    double local = std::numeric_limits<double>::max();
+    for (int i = 0; i < rounds; ++i) {
+        heap = std::min(heap, run_cycles(make_heap));
+        pooled = std::min(pooled, run_cycles(make_pooled));
+        local = std::min(local, run_cycles(make_local));
+    }
+
+    std::cout << "create/connect x" << receivers << "/emit/destroy, "
+              << cycles << " cycles, best of " << rounds << std::endl;
+    std::cout << "  global allocator: " << heap << " ns/cycle" << std::endl;
+    std::cout << "  slot_arena:       " << pooled << " ns/cycle" << std::endl;
+    std::cout << "  slot_arena (single_threaded): " << local << " ns/cycle" << std::endl;
+
+    return 0;
+}
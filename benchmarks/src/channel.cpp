@@ -0,0 +1,130 @@
+/**********************************************************************
+File name: channel.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include "sig11/channel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+
+
+static const int items = 2000000;
+static const std::size_t batch_size = 64;
+static const std::size_t capacity = 1024;
+
+
+/**
+ * The baseline: a bounded std::deque guarded by a std::mutex.
+ */
+class locked_deque
+{
+public:
+    using value_type = std::tuple<int, double>;
+
+private:
+    std::mutex m_mutex;
+    std::deque<value_type> m_queue;
+
+public:
+    bool push(int a, double b)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_queue.size() >= capacity) {
+            return false;
+        }
+        m_queue.emplace_back(a, b);
+        return true;
+    }
+
+    std::size_t try_pop_n(value_type *out, std::size_t n)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::size_t count = std::min(n, m_queue.size());
+        std::move(m_queue.begin(), m_queue.begin() + count, out);
+        m_queue.erase(m_queue.begin(), m_queue.begin() + count);
+        return count;
+    }
+
+};
+
+
+template <typename queue_t>
+static void measure(const std::string &name, queue_t &queue)
+{
+    auto t0 = std::chrono::steady_clock::now();
+
+    std::thread producer([&queue](){
+        for (int i = 0; i < items; ++i) {
+            while (!queue.push(i, 0.5)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::array<std::tuple<int, double>, batch_size> batch;
+    long long sum = 0;
+    int received = 0;
+    while (received < items) {
+        std::size_t n = queue.try_pop_n(batch.data(), batch.size());
+        if (n == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += std::get<0>(batch[i]);
+        }
+        received += static_cast<int>(n);
+    }
+    producer.join();
+
+    auto t1 = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0);
+    std::cout << name << ": "
+              << static_cast<double>(elapsed.count()) / items << " ns/item"
+              << " (checksum " << sum << ")"
+              << std::endl;
+}
+
+
+int main()
+{
+    std::cout << items << " items from one producer to one consumer, "
+              << "capacity " << capacity << ", batches of " << batch_size
+              << std::endl;
+
+    {
+        locked_deque queue;
+        measure("std::deque + mutex", queue);
+    }
+    {
+        sig11::channel<int, double> queue(capacity);
+        measure("sig11::channel    ", queue);
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+/**********************************************************************
+File name: lock_policy.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include "sig11/sig11.hpp"
+#include "sig11/lock_policy.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+
+static const int emits = 2000000;
+static const int rounds = 5;
+
+
+template <typename mutex_t>
+static void measure(const std::string &name)
+{
+    sig11::signal<void(int), sig11::null_tracer, mutex_t> signal;
+    volatile int sink = 0;
+
+    auto guard(sig11::connect(signal, [&sink](int value){ sink = value; }));
+
+    std::chrono::nanoseconds best = std::chrono::nanoseconds::max();
+    for (int round = 0; round < rounds; ++round) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < emits; ++i) {
+            signal(i);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0));
+    }
+
+    std::cout << name << ": "
+              << static_cast<double>(best.count()) / emits << " ns/emit"
+              << std::endl;
+}
+
+
+int main()
+{
+    std::cout << "uncontended emit cost with one receiver, best of "
+              << rounds << " rounds of " << emits << " emits" << std::endl;
+    measure<sig11::null_mutex>("null_mutex  ");
+    measure<std::mutex>("std::mutex  ");
+    measure<sig11::spin_mutex>("spin_mutex  ");
+    measure<sig11::shared_mutex>("shared_mutex");
+    return 0;
+}
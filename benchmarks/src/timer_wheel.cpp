@@ -0,0 +1,162 @@
+/**********************************************************************
+File name: timer_wheel.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include "sig11/delayed_emit.hpp"
+#include "sig11/sig11.hpp"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+
+static const int timers = 1000000;
+static const int max_delay_ms = 10000;
+
+using time_point = std::chrono::steady_clock::time_point;
+
+
+/**
+ * The baseline: a priority queue of std::function timers, cancelled by a
+ * flag which the queue checks when the timer comes due.
+ */
+class queue_scheduler
+{
+public:
+    struct timer
+    {
+        time_point deadline;
+        std::size_t id;
+        std::function<void()> callback;
+
+        bool operator<(const timer &other) const
+        {
+            return deadline > other.deadline;
+        }
+    };
+
+private:
+    std::priority_queue<timer> m_queue;
+    std::vector<bool> m_cancelled;
+
+public:
+    std::size_t schedule_at(time_point when, std::function<void()> &&callback)
+    {
+        const std::size_t id = m_cancelled.size();
+        m_cancelled.push_back(false);
+        m_queue.push(timer{when, id, std::move(callback)});
+        return id;
+    }
+
+    void cancel(std::size_t id)
+    {
+        m_cancelled[id] = true;
+    }
+
+    void advance(time_point now)
+    {
+        while (!m_queue.empty() && m_queue.top().deadline <= now) {
+            timer next = m_queue.top();
+            m_queue.pop();
+            if (!m_cancelled[next.id]) {
+                next.callback();
+            }
+        }
+    }
+
+};
+
+
+template <typename schedule_t, typename cancel_t, typename advance_t>
+static void measure(const std::string &name, const std::vector<int> &delays,
+                    time_point start,
+                    schedule_t &&schedule, cancel_t &&cancel, advance_t &&advance,
+                    const long &sum)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < timers; ++i) {
+        schedule(start + std::chrono::milliseconds(delays[i]), i);
+    }
+    // half of the timers are cancelled, as timeouts usually are
+    for (int i = 0; i < timers; i += 2) {
+        cancel(i);
+    }
+    for (int ms = 1; ms <= max_delay_ms; ++ms) {
+        advance(start + std::chrono::milliseconds(ms));
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0);
+    std::cout << name << ": "
+              << static_cast<double>(elapsed.count()) / timers << " ns/timer"
+              << " (checksum " << sum << ")"
+              << std::endl;
+}
+
+
+int main()
+{
+    std::cout << timers << " delayed emissions within " << max_delay_ms
+              << "ms, half of them cancelled" << std::endl;
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(1, max_delay_ms);
+    std::vector<int> delays(timers);
+    for (int &delay: delays) {
+        delay = dist(rng);
+    }
+
+    {
+        long sum = 0;
+        sig11::signal<void(int)> signal;
+        signal.connect([&sum](int value){ sum += value; });
+        queue_scheduler scheduler;
+        std::vector<std::size_t> handles(timers);
+        const time_point start = std::chrono::steady_clock::now();
+        measure("priority_queue + std::function", delays, start,
+                [&](time_point when, int i){
+                    handles[i] = scheduler.schedule_at(when, [&signal, i](){ signal(i); });
+                },
+                [&](int i){ scheduler.cancel(handles[i]); },
+                [&](time_point now){ scheduler.advance(now); },
+                sum);
+    }
+    {
+        long sum = 0;
+        sig11::signal<void(int)> signal;
+        signal.connect([&sum](int value){ sum += value; });
+        const time_point start = std::chrono::steady_clock::now();
+        sig11::timer_wheel wheel(std::chrono::milliseconds(1), start);
+        std::vector<sig11::timer_handle> handles(timers);
+        measure("sig11::timer_wheel            ", delays, start,
+                [&](time_point when, int i){
+                    handles[i] = sig11::emit_at(wheel, signal, when, i);
+                },
+                [&](int i){ wheel.cancel(handles[i]); },
+                [&](time_point now){ wheel.advance(now); },
+                sum);
+    }
+    return 0;
+}
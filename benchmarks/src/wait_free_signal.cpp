@@ -0,0 +1,91 @@
+/**********************************************************************
+File name: wait_free_signal.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include "sig11/sig11.hpp"
+#include "sig11/wait_free_signal.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+static const int emits = 200000;
+static const int writers = 3;
+
+
+template <typename signal_t>
+static void measure(const std::string &name)
+{
+    signal_t signal;
+    std::atomic<bool> stop(false);
+    volatile int sink = 0;
+
+    auto guard(sig11::connect(signal, [&sink](int value){ sink = value; }));
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < writers; ++i) {
+        threads.emplace_back([&signal, &stop, &sink](){
+            while (!stop.load(std::memory_order_relaxed)) {
+                sig11::connection conn(signal.connect([&sink](int value){ sink = value; }));
+                signal.disconnect(conn);
+            }
+        });
+    }
+
+    std::vector<std::chrono::nanoseconds> latencies;
+    latencies.reserve(emits);
+    for (int i = 0; i < emits; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        signal(i);
+        auto t1 = std::chrono::steady_clock::now();
+        latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0));
+    }
+
+    stop = true;
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << name << ": "
+              << "p50 " << latencies[latencies.size() / 2].count() << " ns, "
+              << "p99 " << latencies[latencies.size() * 99 / 100].count() << " ns, "
+              << "p99.99 " << latencies[latencies.size() * 9999 / 10000].count() << " ns, "
+              << "max " << latencies.back().count() << " ns"
+              << std::endl;
+}
+
+
+int main()
+{
+    std::cout << "emit latency with " << writers
+              << " threads hammering connect/disconnect, "
+              << emits << " emits" << std::endl;
+    measure<sig11::signal<void(int)> >("signal          ");
+    measure<sig11::wait_free_signal<void(int)> >("wait_free_signal");
+    return 0;
+}
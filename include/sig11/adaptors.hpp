@@ -0,0 +1,258 @@
+/**********************************************************************
+File name: adaptors.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_ADAPTORS_H
+#define SIG11_ADAPTORS_H
+
+#include <type_traits>
+#include <utility>
+
+#include "sig11/sig11.hpp"
+
+
+namespace sig11 {
+
+namespace detail {
+
+template <typename predicate_t, typename next_t>
+struct filter_stage
+{
+    predicate_t predicate;
+    next_t next;
+
+    template <typename... arg_ts>
+    inline void operator()(const arg_ts&... args)
+    {
+        if (predicate(args...)) {
+            next(args...);
+        }
+    }
+};
+
+template <typename function_t, typename next_t>
+struct transform_stage
+{
+    function_t function;
+    next_t next;
+
+    template <typename... arg_ts>
+    inline void operator()(const arg_ts&... args)
+    {
+        next(function(args...));
+    }
+};
+
+template <typename predicate_t>
+struct filter_adaptor
+{
+    predicate_t predicate;
+
+    template <typename next_t>
+    inline filter_stage<predicate_t, typename std::decay<next_t>::type> bind(next_t &&next) const
+    {
+        return {predicate, std::forward<next_t>(next)};
+    }
+};
+
+template <typename function_t>
+struct transform_adaptor
+{
+    function_t function;
+
+    template <typename next_t>
+    inline transform_stage<function_t, typename std::decay<next_t>::type> bind(next_t &&next) const
+    {
+        return {function, std::forward<next_t>(next)};
+    }
+};
+
+/**
+ * Two adaptors applied one after the other.
+ */
+template <typename first_t, typename second_t>
+struct composed_adaptor
+{
+    first_t first;
+    second_t second;
+
+    template <typename next_t>
+    inline auto bind(next_t &&next) const
+    {
+        return first.bind(second.bind(std::forward<next_t>(next)));
+    }
+};
+
+template <typename T>
+struct is_adaptor: std::false_type
+{
+
+};
+
+template <typename predicate_t>
+struct is_adaptor<filter_adaptor<predicate_t> >: std::true_type
+{
+
+};
+
+template <typename function_t>
+struct is_adaptor<transform_adaptor<function_t> >: std::true_type
+{
+
+};
+
+template <typename first_t, typename second_t>
+struct is_adaptor<composed_adaptor<first_t, second_t> >: std::true_type
+{
+
+};
+
+}
+
+
+/**
+ * A derived event stream: a source signal with a chain of adaptors.
+ *
+ * A pipeline is created by applying adaptors to a signal with operator|,
+ * as in `signal | sig11::filter(p) | sig11::transform(f)`. It does not
+ * have receivers of its own; connecting a receiver to the pipeline fuses
+ * the adaptors and the receiver into a single callable at compile time,
+ * which is connected to the source signal. An emission of the source thus
+ * costs one receiver call, in which the adaptors are inlined, instead of a
+ * chain of intermediate signals.
+ *
+ * The source signal must outlive the pipeline; the returned connections
+ * belong to the source signal.
+ */
+template <typename signal_t, typename adaptor_t>
+class pipeline
+{
+public:
+    using source_type = signal_t;
+    using call_t = typename signal_t::call_t;
+
+public:
+    pipeline(signal_t &source, const adaptor_t &adaptor):
+        m_source(source),
+        m_adaptor(adaptor)
+    {
+
+    }
+
+private:
+    signal_t &m_source;
+    adaptor_t m_adaptor;
+
+public:
+    /**
+     * Connect a \a receiver to the end of the pipeline.
+     *
+     * @return A connection of the source signal.
+     */
+    template <typename callable_t>
+    connection connect(callable_t &&receiver) const
+    {
+        return m_source.connect(m_adaptor.bind(std::forward<callable_t>(receiver)));
+    }
+
+    /**
+     * The signal the pipeline is connected to.
+     */
+    inline signal_t &source() const
+    {
+        return m_source;
+    }
+
+    inline const adaptor_t &adaptor() const
+    {
+        return m_adaptor;
+    }
+
+};
+
+
+/**
+ * Adaptor which passes on only the emissions for which \a predicate returns
+ * true.
+ */
+template <typename predicate_t>
+static inline detail::filter_adaptor<typename std::decay<predicate_t>::type> filter(
+        predicate_t &&predicate)
+{
+    return {std::forward<predicate_t>(predicate)};
+}
+
+/**
+ * Adaptor which passes on the result of \a function, called with the
+ * arguments of each emission.
+ */
+template <typename function_t>
+static inline detail::transform_adaptor<typename std::decay<function_t>::type> transform(
+        function_t &&function)
+{
+    return {std::forward<function_t>(function)};
+}
+
+/**
+ * Start a pipeline on \a source.
+ */
+template <typename signal_t, typename adaptor_t,
+          typename = typename std::enable_if<detail::is_adaptor<adaptor_t>::value>::type>
+static inline pipeline<signal_t, adaptor_t> operator|(signal_t &source,
+                                                      const adaptor_t &adaptor)
+{
+    return pipeline<signal_t, adaptor_t>(source, adaptor);
+}
+
+/**
+ * Append an adaptor to a pipeline.
+ */
+template <typename signal_t, typename first_t, typename adaptor_t,
+          typename = typename std::enable_if<detail::is_adaptor<adaptor_t>::value>::type>
+static inline pipeline<signal_t, detail::composed_adaptor<first_t, adaptor_t> > operator|(
+        const pipeline<signal_t, first_t> &source,
+        const adaptor_t &adaptor)
+{
+    return pipeline<signal_t, detail::composed_adaptor<first_t, adaptor_t> >(
+                source.source(),
+                detail::composed_adaptor<first_t, adaptor_t>{source.adaptor(), adaptor});
+}
+
+/**
+ * Connect a \a receiver to the end of a pipeline.
+ *
+ * It returns a connection_guard for the new connection of the source
+ * signal.
+ */
+template <typename signal_t, typename adaptor_t, typename callable_t>
+static inline connection_guard<typename signal_t::call_t> connect [[gnu::warn_unused_result]] (
+        const pipeline<signal_t, adaptor_t> &stream,
+        callable_t &&receiver)
+{
+    return connection_guard<typename signal_t::call_t>(
+                stream.connect(std::forward<callable_t>(receiver)),
+                stream.source());
+}
+
+}
+
+#endif
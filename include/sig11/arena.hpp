@@ -0,0 +1,380 @@
+/**********************************************************************
+File name: arena.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_ARENA_H
+#define SIG11_ARENA_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "sig11/lock_policy.hpp"
+
+
+namespace sig11 {
+
+/**
+ * A slot_arena recycles the small blocks which signals allocate for their
+ * receivers (container nodes and callable storage).
+ *
+ * Blocks are grouped into size classes of #granularity bytes. Freed blocks
+ * are kept on a per-class free list and handed out again by the next
+ * allocation of the same class, so that signals which are created and
+ * destroyed in quick succession stop hitting the global allocator once the
+ * arena has warmed up. Memory is only returned to the system when the arena
+ * is destroyed.
+ *
+ * Requests larger than #max_block_size or with an alignment stricter than
+ * #granularity are forwarded to the global operator new.
+ *
+ * By default, all operations on an arena are thread-safe. The thread which
+ * constructs the arena (its owner) has free lists of its own, on which it
+ * allocates and frees without any locking; this is the fast path, which is
+ * meant for signals which are created and destroyed on the thread which
+ * owns their arena. Other threads share a second set of free lists, which
+ * is guarded by a spin_mutex; the owner only takes that lock to refill an
+ * empty list from the shared one or to carve a new block from a chunk.
+ * With the shared lists, an arena used from other threads is somewhat
+ * slower than the global allocator.
+ *
+ * An arena which is constructed with #single_threaded skips the locking
+ * altogether; it must then only be used by a single thread at a time,
+ * which includes connecting to, disconnecting from and destroying the
+ * signals which use it.
+ *
+ * An arena must outlive all signals which use it.
+ *
+ * @see signal::signal(slot_arena&)
+ */
+class slot_arena
+{
+public:
+    static constexpr std::size_t granularity = 16;
+    static constexpr std::size_t max_block_size = 256;
+    static constexpr std::size_t chunk_size = 16384;
+
+    struct single_threaded_t
+    {
+    };
+
+    /**
+     * Tag to construct an arena without internal locking.
+     */
+    static constexpr single_threaded_t single_threaded{};
+
+public:
+    /**
+     * Construct a thread-safe arena.
+     */
+    slot_arena();
+
+    /**
+     * Construct an arena without internal locking.
+     */
+    explicit slot_arena(single_threaded_t);
+    ~slot_arena();
+
+    slot_arena(const slot_arena &ref) = delete;
+    slot_arena &operator=(const slot_arena &ref) = delete;
+    slot_arena(slot_arena &&src) = delete;
+    slot_arena &operator=(slot_arena &&src) = delete;
+
+private:
+    struct free_block
+    {
+        free_block *next;
+    };
+
+    static constexpr std::size_t size_classes = max_block_size / granularity;
+
+    /**
+     * Locks the arena, unless it is single-threaded.
+     */
+    class lock_guard
+    {
+    public:
+        explicit lock_guard(const slot_arena &arena);
+        ~lock_guard();
+
+    private:
+        spin_mutex *m_mutex;
+    };
+
+    const bool m_synchronized;
+    /**
+     * Thread tag (see current_thread()) of the owner.
+     */
+    const void *const m_owner;
+
+    /* only accessed by the owner */
+    std::array<free_block*, size_classes> m_local_lists;
+
+    /**
+     * Blocks allocated minus blocks freed by the owner; only written by the
+     * owner.
+     */
+    std::atomic<std::ptrdiff_t> m_local_in_use;
+
+    /* guarded by m_lock */
+    mutable spin_mutex m_lock;
+    std::array<free_block*, size_classes> m_free_lists;
+    std::vector<char*> m_chunks;
+    char *m_chunk_cursor;
+    char *m_chunk_end;
+    std::ptrdiff_t m_blocks_in_use;
+
+    /**
+     * A tag which is unique among the running threads, and cheaper to
+     * obtain than std::this_thread::get_id().
+     */
+    static inline const void *current_thread()
+    {
+        static thread_local const char tag = 0;
+        return &tag;
+    }
+
+    inline bool is_owner() const
+    {
+        return !m_synchronized || current_thread() == m_owner;
+    }
+
+    void *carve(std::size_t cls);
+
+public:
+    /**
+     * Allocate a block of at least \a size bytes with the given \a align.
+     *
+     * @throws std::bad_alloc if the memory cannot be obtained.
+     */
+    void *allocate(std::size_t size, std::size_t align);
+
+    /**
+     * Return a block obtained from allocate() to the arena.
+     *
+     * \a size and \a align must be the values passed to allocate().
+     */
+    void deallocate(void *ptr, std::size_t size, std::size_t align) noexcept;
+
+    /**
+     * The number of arena blocks which are currently handed out.
+     */
+    std::size_t blocks_in_use() const;
+
+    /**
+     * The number of bytes the arena has reserved from the global allocator.
+     */
+    std::size_t reserved_bytes() const;
+
+};
+
+
+/**
+ * Standard allocator adaptor which draws from a slot_arena.
+ *
+ * An arena_allocator without an arena (the default) uses the global operator
+ * new and delete.
+ */
+template <typename T>
+class arena_allocator
+{
+public:
+    using value_type = T;
+
+public:
+    arena_allocator(slot_arena *arena = nullptr) noexcept:
+        m_arena(arena)
+    {
+
+    }
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U> &other) noexcept:
+        m_arena(other.arena())
+    {
+
+    }
+
+private:
+    slot_arena *m_arena;
+
+public:
+    T *allocate(std::size_t n)
+    {
+        if (m_arena) {
+            return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T *ptr, std::size_t n) noexcept
+    {
+        if (m_arena) {
+            m_arena->deallocate(ptr, n * sizeof(T), alignof(T));
+            return;
+        }
+        ::operator delete(ptr);
+    }
+
+    inline slot_arena *arena() const
+    {
+        return m_arena;
+    }
+
+};
+
+template <typename T, typename U>
+static inline bool operator==(const arena_allocator<T> &a, const arena_allocator<U> &b)
+{
+    return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+static inline bool operator!=(const arena_allocator<T> &a, const arena_allocator<U> &b)
+{
+    return a.arena() != b.arena();
+}
+
+
+namespace detail {
+
+/**
+ * Type-specific operations of an arena_box, shared by all boxes of a type.
+ */
+struct arena_box_ops
+{
+    void (*destroy)(void *obj);
+    std::size_t size;
+    std::size_t align;
+};
+
+template <typename T>
+struct arena_box_ops_for
+{
+    static void destroy(void *obj)
+    {
+        static_cast<T*>(obj)->~T();
+    }
+
+    static constexpr arena_box_ops ops{&destroy, sizeof(T), alignof(T)};
+};
+
+template <typename T>
+constexpr arena_box_ops arena_box_ops_for<T>::ops;
+
+/**
+ * Owning handle for an object constructed in a slot_arena (or on the heap if
+ * no arena is given).
+ *
+ * The handle is three pointers large; the size, alignment and destructor of
+ * the object are kept in a static arena_box_ops per type.
+ */
+class arena_box
+{
+public:
+    arena_box():
+        m_arena(nullptr),
+        m_ptr(nullptr),
+        m_ops(nullptr)
+    {
+
+    }
+
+    template <typename T, typename... arg_ts>
+    static arena_box make(slot_arena *arena, arg_ts&&... args)
+    {
+        arena_allocator<T> alloc(arena);
+        T *ptr = alloc.allocate(1);
+        try {
+            new (ptr) T(std::forward<arg_ts>(args)...);
+        } catch (...) {
+            alloc.deallocate(ptr, 1);
+            throw;
+        }
+        arena_box result;
+        result.m_arena = arena;
+        result.m_ptr = ptr;
+        result.m_ops = &arena_box_ops_for<T>::ops;
+        return result;
+    }
+
+    arena_box(const arena_box &ref) = delete;
+    arena_box &operator=(const arena_box &ref) = delete;
+
+    arena_box(arena_box &&src):
+        m_arena(src.m_arena),
+        m_ptr(src.m_ptr),
+        m_ops(src.m_ops)
+    {
+        src.m_ptr = nullptr;
+    }
+
+    arena_box &operator=(arena_box &&src)
+    {
+        reset();
+        m_arena = src.m_arena;
+        m_ptr = src.m_ptr;
+        m_ops = src.m_ops;
+        src.m_ptr = nullptr;
+        return *this;
+    }
+
+    ~arena_box()
+    {
+        reset();
+    }
+
+private:
+    slot_arena *m_arena;
+    void *m_ptr;
+    const arena_box_ops *m_ops;
+
+public:
+    inline void *get() const
+    {
+        return m_ptr;
+    }
+
+    void reset()
+    {
+        if (!m_ptr) {
+            return;
+        }
+        m_ops->destroy(m_ptr);
+        if (m_arena) {
+            m_arena->deallocate(m_ptr, m_ops->size, m_ops->align);
+        } else {
+            ::operator delete(m_ptr);
+        }
+        m_ptr = nullptr;
+    }
+
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,712 @@
+/**********************************************************************
+File name: channel.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_CHANNEL_H
+#define SIG11_CHANNEL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "sig11/sig11.hpp"
+
+
+namespace sig11 {
+
+/**
+ * What a channel does with an emission which does not fit anymore
+ * (backpressure).
+ */
+enum class overflow_policy
+{
+    /**
+     * Discard the new emission.
+     */
+    drop_newest,
+
+    /**
+     * Discard the oldest queued emission to make room for the new one.
+     */
+    drop_oldest,
+
+    /**
+     * Make the emitter sleep until a consumer has made room.
+     */
+    block,
+
+    /**
+     * Replace a queued emission with the same key by the new one; if there
+     * is none, discard the new emission.
+     */
+    coalesce,
+
+    /**
+     * Throw channel_full to the emitter.
+     */
+    fail,
+};
+
+
+/**
+ * Thrown by a channel with overflow_policy::fail if it is full.
+ */
+class channel_full: public std::runtime_error
+{
+public:
+    channel_full():
+        std::runtime_error("sig11::channel is full")
+    {
+
+    }
+
+};
+
+
+/**
+ * Key comparison for overflow_policy::coalesce which compares the element
+ * \a index of the queued argument tuples.
+ */
+template <std::size_t index>
+struct same_element
+{
+    template <typename tuple_t>
+    inline bool operator()(const tuple_t &a, const tuple_t &b) const
+    {
+        return std::get<index>(a) == std::get<index>(b);
+    }
+};
+
+
+/**
+ * A channel queues the emissions of signals in a bounded ring buffer, from
+ * which a consumer pulls them in batches on its own schedule.
+ *
+ * A channel is connected to one or more signals with sig11::connect() (or
+ * by connecting a reference to it); each emission stores a copy of its
+ * arguments as a #value_type tuple. The consumer takes them out with
+ * try_pop() or try_pop_n().
+ *
+ * The ring buffer is lock-free and based on per-cell sequence numbers
+ * (Vyukov's bounded MPMC queue): any number of threads may emit into the
+ * channel and any number of threads may consume from it, and neither side
+ * allocates. The capacity is rounded up to a power of two.
+ *
+ * When the channel is full, the #overflow_policy decides what happens to
+ * the new emission. Each channel counts the emissions which were dropped,
+ * coalesced, rejected or had to wait, so that overload can be monitored.
+ * With overflow_policy::coalesce, consumers may briefly see the channel as
+ * empty while a producer inspects a queued emission.
+ *
+ * If copying the arguments of an emission throws, push() passes the
+ * exception on and the cell it had claimed is skipped by the consumers.
+ */
+template <typename... arg_ts>
+class channel
+{
+public:
+    using value_type = std::tuple<typename std::decay<arg_ts>::type...>;
+    using key_equal = std::function<bool(const value_type&, const value_type&)>;
+
+public:
+    /**
+     * Construct an empty channel.
+     *
+     * @param capacity Minimum number of emissions the channel can hold.
+     * @param policy What to do with emissions when the channel is full.
+     * @throws std::invalid_argument if \a policy is overflow_policy::coalesce;
+     * use the constructor which takes a key_equal instead.
+     */
+    explicit channel(std::size_t capacity,
+                     overflow_policy policy = overflow_policy::drop_newest):
+        channel(capacity, policy, key_equal())
+    {
+        if (policy == overflow_policy::coalesce) {
+            throw std::invalid_argument("coalescing channels need a key");
+        }
+    }
+
+    /**
+     * Construct an empty channel with overflow_policy::coalesce.
+     *
+     * @param capacity Minimum number of emissions the channel can hold.
+     * @param same_key Returns true if two emissions have the same key; for
+     * example same_element<0>().
+     */
+    channel(std::size_t capacity, key_equal same_key):
+        channel(capacity, overflow_policy::coalesce, std::move(same_key))
+    {
+
+    }
+
+    channel(const channel &ref) = delete;
+    channel &operator=(const channel &ref) = delete;
+    channel(channel &&src) = delete;
+    channel &operator=(channel &&src) = delete;
+
+    ~channel()
+    {
+        while (drop_oldest()) {
+        }
+    }
+
+private:
+    static constexpr std::size_t cache_line_size = 64;
+
+    /**
+     * Sequence number of a cell which is being inspected by a coalescing
+     * producer or read by a consumer of a coalescing channel.
+     */
+    static constexpr std::size_t busy = ~std::size_t(0);
+
+    channel(std::size_t capacity, overflow_policy policy, key_equal &&same_key):
+        m_policy(policy),
+        m_same_key(std::move(same_key)),
+        m_mask(round_capacity(capacity) - 1),
+        m_cells(new cell[m_mask + 1]),
+        m_enqueue_pos(0),
+        m_dequeue_pos(0),
+        m_dropped(0),
+        m_coalesced(0),
+        m_rejected(0),
+        m_blocked(0),
+        m_waiting(0)
+    {
+        for (std::size_t i = 0; i <= m_mask; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            m_cells[i].poisoned = false;
+        }
+    }
+
+    struct cell
+    {
+        std::atomic<std::size_t> sequence;
+
+        /**
+         * Set if constructing the value threw; the cell is published
+         * without a value so that the consumers do not stall on it.
+         */
+        bool poisoned;
+
+        typename std::aligned_storage<sizeof(value_type),
+                                      alignof(value_type)>::type storage;
+
+        inline value_type *value()
+        {
+            return reinterpret_cast<value_type*>(&storage);
+        }
+    };
+
+    const overflow_policy m_policy;
+    const key_equal m_same_key;
+    const std::size_t m_mask;
+    const std::unique_ptr<cell[]> m_cells;
+
+    // producers and consumers hammer on different cache lines
+    char m_pad0[cache_line_size];
+    std::atomic<std::size_t> m_enqueue_pos;
+    char m_pad1[cache_line_size - sizeof(std::atomic<std::size_t>)];
+    std::atomic<std::size_t> m_dequeue_pos;
+    char m_pad2[cache_line_size - sizeof(std::atomic<std::size_t>)];
+
+    std::atomic<std::uint64_t> m_dropped;
+    std::atomic<std::uint64_t> m_coalesced;
+    std::atomic<std::uint64_t> m_rejected;
+    std::atomic<std::uint64_t> m_blocked;
+
+    /**
+     * Producers sleeping on #m_room with overflow_policy::block.
+     */
+    std::atomic<std::size_t> m_waiting;
+    std::mutex m_room_mutex;
+    std::condition_variable m_room;
+
+    static std::size_t round_capacity(std::size_t capacity)
+    {
+        std::size_t result = 2;
+        while (result < capacity) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    /**
+     * Claim the next free cell for writing, or return nullptr if the
+     * channel is full. On success, \a pos is the position of the cell.
+     */
+    cell *claim_enqueue(std::size_t &pos)
+    {
+        pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell &c = m_cells[pos & m_mask];
+            const std::size_t seq = c.sequence.load(std::memory_order_acquire);
+            const std::intptr_t diff = static_cast<std::intptr_t>(seq) -
+                    static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueue_pos.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed))
+                {
+                    return &c;
+                }
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Claim the oldest filled cell for reading, or return nullptr if the
+     * channel is empty. On success, \a pos is the position of the cell.
+     */
+    cell *claim_dequeue(std::size_t &pos)
+    {
+        pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell &c = m_cells[pos & m_mask];
+            const std::size_t seq = c.sequence.load(std::memory_order_acquire);
+            const std::intptr_t diff = static_cast<std::intptr_t>(seq) -
+                    static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (m_dequeue_pos.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed))
+                {
+                    return &c;
+                }
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Take exclusive access to the claimed cell \a c at \a pos before
+     * reading it. Only coalescing producers touch queued cells, so this is
+     * a no-op for the other policies.
+     */
+    void lock_dequeued(cell *c, std::size_t pos)
+    {
+        if (m_policy != overflow_policy::coalesce) {
+            return;
+        }
+        std::size_t expected = pos + 1;
+        while (!c->sequence.compare_exchange_weak(
+                   expected, busy, std::memory_order_acquire,
+                   std::memory_order_relaxed))
+        {
+            expected = pos + 1;
+            std::this_thread::yield();
+        }
+    }
+
+    void release_dequeued(cell *c, std::size_t pos)
+    {
+        if (c->poisoned) {
+            c->poisoned = false;
+        } else {
+            c->value()->~value_type();
+        }
+        c->sequence.store(pos + m_mask + 1, std::memory_order_release);
+    }
+
+    /**
+     * Replace the newest queued emission with the same key as \a incoming.
+     *
+     * This scans the queued cells and thus only runs when the channel is
+     * full.
+     */
+    bool try_coalesce(value_type &incoming)
+    {
+        // the dequeue position must be loaded first, so that it does not
+        // overtake the end
+        const std::size_t begin = m_dequeue_pos.load(std::memory_order_acquire);
+        const std::size_t end = m_enqueue_pos.load(std::memory_order_acquire);
+        // replace the newest emission with the key, so that the emissions
+        // of a producer stay in order
+        for (std::size_t pos = end; pos != begin;) {
+            --pos;
+            cell &c = m_cells[pos & m_mask];
+            std::size_t expected = pos + 1;
+            if (!c.sequence.compare_exchange_strong(
+                        expected, busy, std::memory_order_acquire,
+                        std::memory_order_relaxed))
+            {
+                // consumed, being written or inspected by somebody else
+                continue;
+            }
+            if (c.poisoned) {
+                c.sequence.store(pos + 1, std::memory_order_release);
+                continue;
+            }
+            const bool match = m_same_key(*c.value(), incoming);
+            if (match) {
+                *c.value() = std::move(incoming);
+            }
+            c.sequence.store(pos + 1, std::memory_order_release);
+            if (match) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Wake the producers which wait for room, after a consumer has released
+     * cells. Only overflow_policy::block has such producers.
+     */
+    void notify_room()
+    {
+        if (m_policy != overflow_policy::block) {
+            return;
+        }
+        // an RMW instead of a load, so that it is ordered with the one in
+        // wait_for_room(): either the producer sees the released cell or we
+        // see the producer
+        if (m_waiting.fetch_add(0, std::memory_order_acq_rel) > 0) {
+            std::lock_guard<std::mutex> lock(m_room_mutex);
+            m_room.notify_all();
+        }
+    }
+
+    /**
+     * Sleep until the emission fits into the channel and queue it.
+     */
+    void wait_for_room(const arg_ts&... args)
+    {
+        std::unique_lock<std::mutex> lock(m_room_mutex);
+        m_waiting.fetch_add(1, std::memory_order_acq_rel);
+        try {
+            while (!try_push(args...)) {
+                m_room.wait(lock);
+            }
+        } catch (...) {
+            m_waiting.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+        m_waiting.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    bool try_push(const arg_ts&... args)
+    {
+        std::size_t pos;
+        cell *c = claim_enqueue(pos);
+        if (!c) {
+            return false;
+        }
+        try {
+            new (c->value()) value_type(args...);
+        } catch (...) {
+            // the cell has been claimed and must be published in any case
+            c->poisoned = true;
+            c->sequence.store(pos + 1, std::memory_order_release);
+            throw;
+        }
+        c->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool drop_oldest()
+    {
+        for (;;) {
+            std::size_t pos;
+            cell *c = claim_dequeue(pos);
+            if (!c) {
+                return false;
+            }
+            lock_dequeued(c, pos);
+            const bool poisoned = c->poisoned;
+            release_dequeued(c, pos);
+            if (!poisoned) {
+                return true;
+            }
+        }
+    }
+
+public:
+    /**
+     * Queue an emission with the given arguments.
+     *
+     * This function is thread-safe. It is lock-free unless the channel is
+     * full and the policy is overflow_policy::block.
+     *
+     * @return true if the emission was queued or coalesced, false if it was
+     * discarded.
+     * @throws channel_full if the channel is full and the policy is
+     * overflow_policy::fail.
+     * @throws Whatever copying the arguments throws; the emission is then
+     * discarded.
+     */
+    bool push(const arg_ts&... args)
+    {
+        if (try_push(args...)) {
+            return true;
+        }
+
+        switch (m_policy) {
+        case overflow_policy::drop_newest:
+        {
+            break;
+        }
+        case overflow_policy::drop_oldest:
+        {
+            do {
+                // if a consumer got there first, there is room now anyway
+                if (drop_oldest()) {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+            } while (!try_push(args...));
+            return true;
+        }
+        case overflow_policy::block:
+        {
+            m_blocked.fetch_add(1, std::memory_order_relaxed);
+            wait_for_room(args...);
+            return true;
+        }
+        case overflow_policy::coalesce:
+        {
+            value_type incoming(args...);
+            if (try_coalesce(incoming)) {
+                m_coalesced.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            // room may have been made while scanning
+            if (try_push(args...)) {
+                return true;
+            }
+            break;
+        }
+        case overflow_policy::fail:
+        {
+            m_rejected.fetch_add(1, std::memory_order_relaxed);
+            throw channel_full();
+        }
+        }
+
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /**
+     * Slot interface; equivalent to push().
+     */
+    inline void operator()(const arg_ts&... args)
+    {
+        push(args...);
+    }
+
+    /**
+     * Move the oldest queued emission into \a out.
+     *
+     * This function is thread-safe. It is lock-free unless producers wait
+     * for room with overflow_policy::block.
+     *
+     * @return true if an emission was dequeued, false if the channel was
+     * empty.
+     */
+    bool try_pop(value_type &out)
+    {
+        for (;;) {
+            std::size_t pos;
+            cell *c = claim_dequeue(pos);
+            if (!c) {
+                return false;
+            }
+            lock_dequeued(c, pos);
+            const bool poisoned = c->poisoned;
+            if (!poisoned) {
+                out = std::move(*c->value());
+            }
+            release_dequeued(c, pos);
+            if (!poisoned) {
+                notify_room();
+                return true;
+            }
+        }
+    }
+
+    /**
+     * Move up to \a n of the oldest queued emissions into the array
+     * starting at \a out.
+     *
+     * The emissions which are ready are claimed with a single atomic
+     * operation. This function is thread-safe. It is lock-free unless
+     * producers wait for room with overflow_policy::block.
+     *
+     * @return The number of emissions which were dequeued.
+     */
+    std::size_t try_pop_n(value_type *out, std::size_t n)
+    {
+        if (n == 0) {
+            return 0;
+        }
+        std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        std::size_t count;
+        for (;;) {
+            // count the run of filled cells at pos and claim all of them at
+            // once
+            count = 0;
+            while (count < n &&
+                   m_cells[(pos + count) & m_mask].sequence.load(
+                       std::memory_order_acquire) == pos + count + 1)
+            {
+                ++count;
+            }
+            if (count == 0) {
+                const std::size_t seq = m_cells[pos & m_mask].sequence.load(
+                            std::memory_order_acquire);
+                if (static_cast<std::intptr_t>(seq) -
+                        static_cast<std::intptr_t>(pos + 1) < 0)
+                {
+                    return 0;
+                }
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (m_dequeue_pos.compare_exchange_weak(
+                        pos, pos + count, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+
+        std::size_t popped = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            cell *c = &m_cells[(pos + i) & m_mask];
+            lock_dequeued(c, pos + i);
+            if (!c->poisoned) {
+                out[popped++] = std::move(*c->value());
+            }
+            release_dequeued(c, pos + i);
+        }
+        notify_room();
+        if (popped == 0) {
+            // only skipped cells; there may be emissions behind them
+            return try_pop_n(out, n);
+        }
+        return popped;
+    }
+
+    /**
+     * The number of emissions the channel can hold.
+     */
+    inline std::size_t capacity() const
+    {
+        return m_mask + 1;
+    }
+
+    /**
+     * The overflow policy of the channel.
+     */
+    inline overflow_policy policy() const
+    {
+        return m_policy;
+    }
+
+    /**
+     * The number of emissions which were discarded because the channel was
+     * full (the new ones with overflow_policy::drop_newest and
+     * overflow_policy::coalesce, the queued ones with
+     * overflow_policy::drop_oldest).
+     */
+    inline std::uint64_t dropped() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * The number of emissions which replaced a queued emission with the
+     * same key.
+     */
+    inline std::uint64_t coalesced() const
+    {
+        return m_coalesced.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * The number of emissions for which channel_full was thrown.
+     */
+    inline std::uint64_t rejected() const
+    {
+        return m_rejected.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * The number of emissions which had to wait for room.
+     */
+    inline std::uint64_t blocked() const
+    {
+        return m_blocked.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Return true if no emission is queued. With concurrent producers or
+     * consumers, the result may be outdated by the time it is returned.
+     */
+    bool empty() const
+    {
+        return m_dequeue_pos.load(std::memory_order_acquire) ==
+                m_enqueue_pos.load(std::memory_order_acquire);
+    }
+
+};
+
+
+/**
+ * Connect the \a channel to a \a signal with a matching signature.
+ *
+ * The channel is connected by reference and must outlive the connection.
+ *
+ * It returns a connection_guard for the new connection.
+ */
+template <typename result_t, typename... signal_arg_ts, typename tracer_t,
+          typename mutex_t, typename... arg_ts>
+static inline connection_guard<result_t(signal_arg_ts...)> connect [[gnu::warn_unused_result]] (
+        signal<result_t(signal_arg_ts...), tracer_t, mutex_t> &signal,
+        channel<arg_ts...> &channel)
+{
+    static_assert(std::is_same<std::tuple<typename std::decay<signal_arg_ts>::type...>,
+                               typename sig11::channel<arg_ts...>::value_type>::value,
+                  "channel does not match the signal signature");
+    sig11::channel<arg_ts...> *target = &channel;
+    return connection_guard<result_t(signal_arg_ts...)>(
+                signal.connect([target](const signal_arg_ts&... args){
+                    target->push(args...);
+                }),
+                signal);
+}
+
+}
+
+#endif
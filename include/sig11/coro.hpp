@@ -0,0 +1,138 @@
+/**********************************************************************
+File name: coro.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_CORO_H
+#define SIG11_CORO_H
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __cpp_impl_coroutine >= 201902L && __has_include(<coroutine>)
+#define SIG11_HAS_COROUTINES 1
+#endif
+#endif
+
+#ifdef SIG11_HAS_COROUTINES
+
+#include <coroutine>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+
+#include "sig11/sig11.hpp"
+
+
+namespace sig11 {
+
+template <typename signal_t>
+class next_awaiter;
+
+/**
+ * Awaitable for the next emission of a signal.
+ *
+ * The awaiter registers itself as intrusive waiter with the signal (see
+ * signal::add_waiter()); it lives in the coroutine frame, so waiting does
+ * not allocate. co_await yields a std::tuple with copies of the emitted
+ * arguments and resumes the coroutine on the emitting thread.
+ *
+ * If the coroutine is destroyed while it is suspended, the waiter is
+ * removed from the signal. This must not race with an emission of the
+ * signal.
+ *
+ * @see next()
+ */
+template <typename result_t, typename... arg_ts, typename tracer_t, typename mutex_t>
+class next_awaiter<signal<result_t(arg_ts...), tracer_t, mutex_t> >:
+        private detail::emit_waiter<arg_ts...>
+{
+public:
+    using signal_t = signal<result_t(arg_ts...), tracer_t, mutex_t>;
+    using value_type = std::tuple<std::decay_t<arg_ts>...>;
+
+public:
+    explicit next_awaiter(signal_t &signal):
+        detail::emit_waiter<arg_ts...>{nullptr, &next_awaiter::notify_and_resume},
+        m_signal(signal)
+    {
+
+    }
+
+    next_awaiter(const next_awaiter &ref) = delete;
+    next_awaiter &operator=(const next_awaiter &ref) = delete;
+
+    ~next_awaiter()
+    {
+        if (m_handle && !m_values) {
+            m_signal.remove_waiter(*this);
+        }
+    }
+
+private:
+    signal_t &m_signal;
+    std::coroutine_handle<> m_handle;
+    std::optional<value_type> m_values;
+
+    static void notify_and_resume(detail::emit_waiter<arg_ts...> *self,
+                                  const arg_ts&... args)
+    {
+        next_awaiter *awaiter = static_cast<next_awaiter*>(self);
+        awaiter->m_values.emplace(args...);
+        awaiter->m_handle.resume();
+    }
+
+public:
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        m_handle = handle;
+        m_signal.add_waiter(*this);
+    }
+
+    value_type await_resume()
+    {
+        return std::move(*m_values);
+    }
+
+};
+
+
+/**
+ * Wait for the next emission of \a signal in a coroutine:
+ *
+ *     auto [a, b] = co_await sig11::next(signal);
+ *
+ * Only available if the compiler supports C++20 coroutines.
+ */
+template <typename signal_t>
+static inline next_awaiter<signal_t> next(signal_t &signal)
+{
+    return next_awaiter<signal_t>(signal);
+}
+
+}
+
+#endif
+
+#endif
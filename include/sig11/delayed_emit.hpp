@@ -0,0 +1,166 @@
+/**********************************************************************
+File name: delayed_emit.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_DELAYED_EMIT_H
+#define SIG11_DELAYED_EMIT_H
+
+#include <chrono>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "sig11/arena.hpp"
+#include "sig11/timer_wheel.hpp"
+
+
+namespace sig11 {
+
+namespace detail {
+
+/**
+ * An emission with its bound arguments, waiting on a timer_wheel.
+ */
+template <typename signal_t, typename... value_ts>
+struct pending_emission
+{
+    using allocator = arena_allocator<pending_emission>;
+
+    template <typename... arg_ts>
+    pending_emission(signal_t &signal, slot_arena &arena, arg_ts&&... args):
+        signal(signal),
+        arena(arena),
+        args(std::forward<arg_ts>(args)...)
+    {
+
+    }
+
+    signal_t &signal;
+    slot_arena &arena;
+    std::tuple<value_ts...> args;
+
+    template <typename... arg_ts>
+    static pending_emission *make(signal_t &signal, slot_arena &arena, arg_ts&&... args)
+    {
+        allocator alloc(&arena);
+        pending_emission *result = alloc.allocate(1);
+        try {
+            new (result) pending_emission(signal, arena, std::forward<arg_ts>(args)...);
+        } catch (...) {
+            alloc.deallocate(result, 1);
+            throw;
+        }
+        return result;
+    }
+
+    static void discard(void *context)
+    {
+        pending_emission *self = static_cast<pending_emission*>(context);
+        allocator alloc(&self->arena);
+        self->~pending_emission();
+        alloc.deallocate(self, 1);
+    }
+
+    template <std::size_t... indices>
+    inline void emit(std::index_sequence<indices...>)
+    {
+        signal(std::get<indices>(args)...);
+    }
+
+    static void fire(void *context)
+    {
+        pending_emission *self = static_cast<pending_emission*>(context);
+        struct discard_guard
+        {
+            pending_emission *self;
+
+            ~discard_guard()
+            {
+                discard(self);
+            }
+        } guard{self};
+        self->emit(std::index_sequence_for<value_ts...>());
+    }
+};
+
+}
+
+
+/**
+ * Emit \a signal with \a args at \a when, as soon as \a wheel reaches that
+ * time.
+ *
+ * Copies of the arguments are kept with the timer, in the payload arena of
+ * the wheel, and the signal is emitted through its ordinary dispatch from
+ * the thread which advances the wheel. \a signal can be any signal type;
+ * it must not be emitted concurrently from another thread, and must
+ * outlive the pending emission (or the emission must be cancelled).
+ *
+ * This function is thread-safe.
+ *
+ * @return A handle to cancel the emission with timer_wheel::cancel(), which
+ * also destroys the bound arguments.
+ */
+template <typename signal_t, typename... arg_ts>
+static inline timer_handle emit_at(timer_wheel &wheel,
+                                   signal_t &signal,
+                                   timer_wheel::time_point when,
+                                   arg_ts&&... args)
+{
+    using pending_t = detail::pending_emission<signal_t, typename std::decay<arg_ts>::type...>;
+    pending_t *pending = pending_t::make(signal, wheel.payload_arena(),
+                                         std::forward<arg_ts>(args)...);
+    try {
+        return wheel.schedule_at(when, &pending_t::fire, pending, &pending_t::discard);
+    } catch (...) {
+        pending_t::discard(pending);
+        throw;
+    }
+}
+
+/**
+ * Emit \a signal with \a args once \a delay has passed in the time of
+ * \a wheel.
+ *
+ * @see emit_at()
+ */
+template <typename signal_t, typename rep_t, typename period_t, typename... arg_ts>
+static inline timer_handle emit_after(timer_wheel &wheel,
+                                      signal_t &signal,
+                                      std::chrono::duration<rep_t, period_t> delay,
+                                      arg_ts&&... args)
+{
+    using pending_t = detail::pending_emission<signal_t, typename std::decay<arg_ts>::type...>;
+    pending_t *pending = pending_t::make(signal, wheel.payload_arena(),
+                                         std::forward<arg_ts>(args)...);
+    try {
+        return wheel.schedule_after(std::chrono::duration_cast<timer_wheel::duration>(delay),
+                                    &pending_t::fire, pending, &pending_t::discard);
+    } catch (...) {
+        pending_t::discard(pending);
+        throw;
+    }
+}
+
+}
+
+#endif
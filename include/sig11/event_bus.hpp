@@ -0,0 +1,198 @@
+/**********************************************************************
+File name: event_bus.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_EVENT_BUS_H
+#define SIG11_EVENT_BUS_H
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "sig11/sig11.hpp"
+
+
+namespace sig11 {
+
+namespace detail {
+
+/**
+ * Number of occurences of \a T in \a ts.
+ */
+template <typename T, typename... ts>
+struct type_count: std::integral_constant<std::size_t, 0>
+{
+
+};
+
+template <typename T, typename head_t, typename... ts>
+struct type_count<T, head_t, ts...>: std::integral_constant<
+        std::size_t,
+        (std::is_same<T, head_t>::value ? 1 : 0) + type_count<T, ts...>::value>
+{
+
+};
+
+/**
+ * Position of \a T in \a ts; \a T must occur in \a ts.
+ */
+template <typename T, typename... ts>
+struct type_index;
+
+template <typename T, typename... ts>
+struct type_index<T, T, ts...>: std::integral_constant<std::size_t, 0>
+{
+
+};
+
+template <typename T, typename head_t, typename... ts>
+struct type_index<T, head_t, ts...>: std::integral_constant<
+        std::size_t,
+        1 + type_index<T, ts...>::value>
+{
+
+};
+
+template <typename... ts>
+struct all_unique: std::true_type
+{
+
+};
+
+template <typename head_t, typename... ts>
+struct all_unique<head_t, ts...>: std::integral_constant<
+        bool,
+        type_count<head_t, ts...>::value == 0 && all_unique<ts...>::value>
+{
+
+};
+
+}
+
+
+/**
+ * An event_bus dispatches events by their type.
+ *
+ * Each of the \a event_ts gets its own signal<void(const E&)>. The signals
+ * are stored in a tuple and selected by the position of the event type in
+ * \a event_ts, which is resolved at compile time: publish() is a direct
+ * emission of the signal for the event type, without a type lookup at run
+ * time. Using an event type which is not part of the bus is a compile
+ * error.
+ *
+ * The thread-safety guarantees are those of signal, per event type.
+ */
+template <typename... event_ts>
+class event_bus
+{
+public:
+    static_assert(detail::all_unique<event_ts...>::value,
+                  "each event type must be listed only once");
+
+    template <typename event_t>
+    using signal_type = signal<void(const event_t&)>;
+
+    template <typename event_t>
+    using guard_t = connection_guard<void(const event_t&)>;
+
+public:
+    event_bus() = default;
+
+    event_bus(const event_bus &ref) = delete;
+    event_bus &operator=(const event_bus &ref) = delete;
+    event_bus(event_bus &&src) = delete;
+    event_bus &operator=(event_bus &&src) = delete;
+
+private:
+    std::tuple<signal_type<event_ts>...> m_signals;
+
+    template <typename event_t>
+    struct index_of
+    {
+        static_assert(detail::type_count<event_t, event_ts...>::value == 1,
+                      "event type is not part of this event_bus");
+        static constexpr std::size_t value = detail::type_index<event_t, event_ts..., event_t>::value;
+    };
+
+public:
+    /**
+     * The signal for events of type \a event_t.
+     */
+    template <typename event_t>
+    inline signal_type<event_t> &events()
+    {
+        return std::get<index_of<event_t>::value>(m_signals);
+    }
+
+    /**
+     * Emit \a event to the receivers of its type.
+     */
+    template <typename event_t>
+    inline void publish(const event_t &event)
+    {
+        events<event_t>()(event);
+    }
+
+    /**
+     * Connect a \a receiver to the events of type \a event_t.
+     *
+     * This function is thread-safe.
+     *
+     * @return A connection for the newly connected receiver.
+     * @see disconnect()
+     */
+    template <typename event_t, typename callable_t>
+    inline connection connect(callable_t &&receiver)
+    {
+        return events<event_t>().connect(std::forward<callable_t>(receiver));
+    }
+
+    /**
+     * Disconnect a connection \a conn obtained from connect<event_t>().
+     *
+     * This function is thread-safe.
+     */
+    template <typename event_t>
+    inline void disconnect(connection &conn)
+    {
+        events<event_t>().disconnect(conn);
+    }
+
+    /**
+     * Connect a \a receiver to the events of type \a event_t and return a
+     * connection_guard for the new connection.
+     *
+     * This function is thread-safe.
+     */
+    template <typename event_t, typename callable_t>
+    inline guard_t<event_t> subscribe [[gnu::warn_unused_result]] (callable_t &&receiver)
+    {
+        signal_type<event_t> &target = events<event_t>();
+        return guard_t<event_t>(target.connect(std::forward<callable_t>(receiver)), target);
+    }
+
+};
+
+}
+
+#endif
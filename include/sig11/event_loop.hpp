@@ -0,0 +1,235 @@
+/**********************************************************************
+File name: event_loop.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_EVENT_LOOP_H
+#define SIG11_EVENT_LOOP_H
+
+#ifdef __linux__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+#include "sig11/channel.hpp"
+#include "sig11/sig11.hpp"
+
+
+namespace sig11 {
+
+/**
+ * A pollable eventfd with coalesced wakeups.
+ *
+ * notify() only writes to the eventfd if it has not been written to since
+ * the last consume(), so that any number of notifications between two
+ * wakeups of the poller cost a single system call.
+ *
+ * The descriptor is non-blocking and close-on-exec.
+ */
+class wakeup_fd
+{
+public:
+    /**
+     * @throws std::system_error if the eventfd cannot be created.
+     */
+    wakeup_fd();
+    ~wakeup_fd();
+
+    wakeup_fd(const wakeup_fd &ref) = delete;
+    wakeup_fd &operator=(const wakeup_fd &ref) = delete;
+    wakeup_fd(wakeup_fd &&src) = delete;
+    wakeup_fd &operator=(wakeup_fd &&src) = delete;
+
+private:
+    const int m_fd;
+    std::atomic<bool> m_pending;
+
+public:
+    /**
+     * The file descriptor to poll for readability.
+     */
+    inline int fd() const
+    {
+        return m_fd;
+    }
+
+    /**
+     * Make the descriptor readable, unless it already is.
+     *
+     * This function is thread-safe.
+     */
+    void notify();
+
+    /**
+     * Reset the descriptor after it has been reported readable.
+     *
+     * Everything which was published before a notify() that returned before
+     * the start of consume() must be processed after consume() returns.
+     */
+    void consume();
+
+};
+
+
+/**
+ * Bridge which delivers emissions from any thread into an event loop
+ * thread which sleeps in poll(), epoll_wait() or similar.
+ *
+ * Connect the bridge to a source signal with sig11::connect(). Emissions of
+ * the source are queued in a channel and wake up the loop through a
+ * wakeup_fd (see fd()). When the descriptor is readable, the loop thread
+ * calls dispatch(), which drains all pending emissions in one batch and
+ * emits them on target(). Receivers connected to target() thus always run
+ * on the loop thread.
+ *
+ * The queue is bounded; \a policy decides what happens to emissions which
+ * do not fit (see channel). With the default overflow_policy::block, the
+ * loop thread itself must not emit the source signal, as it could wait
+ * for room which only it can make.
+ *
+ * The argument types must be default-constructible.
+ */
+template <typename... arg_ts>
+class event_loop_bridge
+{
+public:
+    using call_t = void(arg_ts...);
+    using target_type = signal<void(arg_ts...)>;
+    using value_type = typename channel<arg_ts...>::value_type;
+
+    /**
+     * Number of emissions which dispatch() takes from the queue at once.
+     */
+    static constexpr std::size_t batch_size = 64;
+
+public:
+    explicit event_loop_bridge(std::size_t capacity,
+                               overflow_policy policy = overflow_policy::block):
+        m_queue(capacity, policy)
+    {
+
+    }
+
+private:
+    channel<arg_ts...> m_queue;
+    wakeup_fd m_wakeup;
+    target_type m_target;
+
+    template <std::size_t... indices>
+    inline void emit_target(const value_type &value, std::index_sequence<indices...>)
+    {
+        m_target(std::get<indices>(value)...);
+    }
+
+public:
+    /**
+     * Queue an emission and wake the loop up. This is the receiver which is
+     * connected to the source signal.
+     *
+     * This function is thread-safe.
+     */
+    void operator()(const arg_ts&... args)
+    {
+        if (m_queue.push(args...)) {
+            m_wakeup.notify();
+        }
+    }
+
+    /**
+     * The file descriptor to poll for readability.
+     */
+    inline int fd() const
+    {
+        return m_wakeup.fd();
+    }
+
+    /**
+     * Emit all pending emissions on target(), in the order in which they
+     * were queued.
+     *
+     * Call this from the loop thread when fd() is readable.
+     *
+     * @return The number of emissions which were delivered.
+     */
+    std::size_t dispatch()
+    {
+        m_wakeup.consume();
+
+        std::array<value_type, batch_size> batch;
+        std::size_t total = 0;
+        std::size_t count;
+        while ((count = m_queue.try_pop_n(batch.data(), batch.size())) > 0) {
+            for (std::size_t i = 0; i < count; ++i) {
+                emit_target(batch[i], std::index_sequence_for<arg_ts...>());
+            }
+            total += count;
+        }
+        return total;
+    }
+
+    /**
+     * The signal on which dispatch() delivers the emissions.
+     */
+    inline target_type &target()
+    {
+        return m_target;
+    }
+
+    /**
+     * The queue of pending emissions, for its overload counters.
+     */
+    inline const channel<arg_ts...> &queue() const
+    {
+        return m_queue;
+    }
+
+};
+
+
+/**
+ * Connect the \a bridge to a source \a signal with a matching signature.
+ *
+ * The bridge is connected by reference and must outlive the connection.
+ *
+ * It returns a connection_guard for the new connection.
+ */
+template <typename result_t, typename... signal_arg_ts, typename tracer_t,
+          typename mutex_t, typename... arg_ts>
+static inline connection_guard<result_t(signal_arg_ts...)> connect [[gnu::warn_unused_result]] (
+        signal<result_t(signal_arg_ts...), tracer_t, mutex_t> &signal,
+        event_loop_bridge<arg_ts...> &bridge)
+{
+    event_loop_bridge<arg_ts...> *target = &bridge;
+    return connection_guard<result_t(signal_arg_ts...)>(
+                signal.connect([target](const signal_arg_ts&... args){
+                    (*target)(args...);
+                }),
+                signal);
+}
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,206 @@
+/**********************************************************************
+File name: fixed_signal.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_FIXED_SIGNAL_H
+#define SIG11_FIXED_SIGNAL_H
+
+#include <array>
+#include <mutex>
+
+#include "sig11/sig11.hpp"
+#include "sig11/inline_function.hpp"
+
+
+namespace sig11 {
+
+template <std::size_t N, typename T, std::size_t inline_size = 2*sizeof(void*)>
+class fixed_signal;
+
+/**
+ * A fixed_signal is a signal with inline storage for up to \a N receivers,
+ * which never allocates.
+ *
+ * Receivers are stored as inline_function objects with \a inline_size bytes
+ * of storage, so only small, trivially copyable callables can be connected.
+ * Once all \a N places are taken, connect() reports that the signal is full
+ * by returning an invalid connection instead of allocating.
+ *
+ * Emission copies the connected receivers onto the stack and invokes the
+ * copies, so connect(), disconnect() and operator() are all free of heap
+ * allocations. This makes fixed_signal suitable for threads which must not
+ * allocate.
+ *
+ * The thread-safety guarantees are the same as those of signal.
+ */
+template <std::size_t N, typename result_t, typename... arg_ts, std::size_t inline_size>
+class fixed_signal<N, result_t(arg_ts...), inline_size>
+{
+public:
+    static_assert(std::is_void<result_t>::value,
+                  "signals with non-void return values are not supported.");
+    static_assert(N > 0, "a fixed_signal needs space for at least one receiver");
+
+    using call_t = result_t(arg_ts...);
+    // receivers get the arguments by reference, as they are shared by all
+    using function_type = inline_function<void(const arg_ts&...), inline_size>;
+    using guard_t = connection_guard<call_t>;
+
+public:
+    /**
+     * Construct a new signal without any connected receivers.
+     */
+    fixed_signal():
+        m_token_id_ctr(0),
+        m_size(0)
+    {
+
+    }
+
+    fixed_signal(const fixed_signal &ref) = delete;
+    fixed_signal &operator=(const fixed_signal &ref) = delete;
+    fixed_signal(fixed_signal &&src) = delete;
+    fixed_signal &operator=(fixed_signal &&src) = delete;
+
+private:
+    struct listener
+    {
+        token_id token;
+        function_type fn;
+    };
+
+    mutable std::mutex m_listeners_mutex;
+    token_id m_token_id_ctr;
+    std::array<listener, N> m_listeners;
+    std::size_t m_size;
+
+public:
+    /**
+     * Emit the signal with the given arguments.
+     *
+     * No two threads must call this function without synchronization.
+     */
+    void operator()(const arg_ts&... args)
+    {
+        std::array<function_type, N> listeners_tmp;
+        std::size_t count;
+        {
+            std::lock_guard<std::mutex> lock(m_listeners_mutex);
+            count = m_size;
+            for (std::size_t i = 0; i < count; ++i) {
+                listeners_tmp[i] = m_listeners[i].fn;
+            }
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            listeners_tmp[i](args...);
+        }
+    }
+
+    /**
+     * Connect a \a receiver to the signal.
+     *
+     * This function is thread-safe.
+     *
+     * @param receiver The callable to connect; it must fit into a
+     *     function_type.
+     * @return A connection for the newly connected receiver, or an invalid
+     *     connection if the signal is full.
+     * @see disconnect()
+     * @see sig11::connect()
+     */
+    connection connect(function_type receiver)
+    {
+        std::lock_guard<std::mutex> lock(m_listeners_mutex);
+        if (m_size == N) {
+            return connection();
+        }
+        token_id token = m_token_id_ctr++;
+        m_listeners[m_size++] = listener{token, receiver};
+        return connection(token);
+    }
+
+    /**
+     * Disconnect a given connection \a conn from the signal.
+     *
+     * If the \a conn is not valid or refers to a non-existent connection, this
+     * is a no-op.
+     *
+     * This function is thread-safe.
+     *
+     * @param conn The connection to disconnect.
+     */
+    void disconnect(connection &conn)
+    {
+        if (!conn) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_listeners_mutex);
+        for (std::size_t i = 0; i < m_size; ++i) {
+            if (m_listeners[i].token != conn.id()) {
+                continue;
+            }
+            for (std::size_t j = i + 1; j < m_size; ++j) {
+                m_listeners[j-1] = m_listeners[j];
+            }
+            --m_size;
+            conn = nullptr;
+            return;
+        }
+    }
+
+    /**
+     * Return true if no further receivers can be connected.
+     */
+    bool full() const
+    {
+        std::lock_guard<std::mutex> lock(m_listeners_mutex);
+        return m_size == N;
+    }
+
+    /**
+     * The maximum number of receivers.
+     */
+    static constexpr std::size_t capacity()
+    {
+        return N;
+    }
+
+};
+
+
+/**
+ * Connect a \a receiver to a fixed_signal and return a connection_guard for
+ * the new connection.
+ *
+ * If the signal is full, the returned guard is empty.
+ */
+template <std::size_t N, typename call_t, std::size_t inline_size, typename callable_t>
+static inline connection_guard<call_t> connect [[gnu::warn_unused_result]] (fixed_signal<N, call_t, inline_size> &signal,
+                                                                            callable_t &&receiver)
+{
+    return connection_guard<call_t>(signal.connect(std::forward<callable_t>(receiver)), signal);
+}
+
+}
+
+#endif
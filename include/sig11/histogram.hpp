@@ -0,0 +1,181 @@
+/**********************************************************************
+File name: histogram.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_HISTOGRAM_H
+#define SIG11_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "sig11/tracer.hpp"
+
+
+namespace sig11 {
+
+/**
+ * A log-bucketed latency histogram in the style of HdrHistogram.
+ *
+ * Each power of two is split into 2^#sub_bucket_bits linear sub-buckets, so
+ * that every recorded value is accurate to within 1/16th (6.25%) of its
+ * magnitude. Values below 2^#sub_bucket_bits nanoseconds are recorded
+ * exactly; values above #max_trackable are clamped.
+ *
+ * Recording only uses relaxed atomic operations and never blocks, so that it
+ * can be done on the emission path while other threads query the
+ * histogram. Queries see a consistent-enough view for monitoring, but not
+ * an atomic snapshot.
+ *
+ * A histogram holds #bucket_count 64-bit counters, which is about 4.7 KiB.
+ */
+class latency_histogram
+{
+public:
+    static constexpr unsigned sub_bucket_bits = 4;
+    static constexpr unsigned max_magnitude = 40;
+    static constexpr std::size_t sub_buckets = std::size_t(1) << sub_bucket_bits;
+    static constexpr std::size_t bucket_count =
+        sub_buckets + (max_magnitude - sub_bucket_bits) * sub_buckets;
+    static constexpr std::uint64_t max_trackable =
+        (std::uint64_t(1) << max_magnitude) - 1;
+
+public:
+    latency_histogram();
+
+    latency_histogram(const latency_histogram &ref) = delete;
+    latency_histogram &operator=(const latency_histogram &ref) = delete;
+
+private:
+    std::array<std::atomic<std::uint64_t>, bucket_count> m_buckets;
+    std::atomic<std::uint64_t> m_count;
+    std::atomic<std::uint64_t> m_total_ns;
+    std::atomic<std::uint64_t> m_max_ns;
+
+public:
+    /**
+     * Return the bucket index for a value of \a ns nanoseconds.
+     */
+    static std::size_t bucket_index(std::uint64_t ns);
+
+    /**
+     * Return the highest value (in nanoseconds) which maps to \a index.
+     */
+    static std::uint64_t bucket_upper_bound(std::size_t index);
+
+    /**
+     * Record a single value.
+     */
+    void record(std::chrono::nanoseconds value);
+
+    /**
+     * Clear all recorded values.
+     */
+    void reset();
+
+    /**
+     * The number of recorded values.
+     */
+    std::uint64_t count() const;
+
+    /**
+     * The sum of all recorded values.
+     */
+    std::chrono::nanoseconds total() const;
+
+    /**
+     * The largest recorded value.
+     */
+    std::chrono::nanoseconds max() const;
+
+    /**
+     * The arithmetic mean of all recorded values, or zero if no values have
+     * been recorded.
+     */
+    std::chrono::nanoseconds mean() const;
+
+    /**
+     * Return the value below or at which \a percent percent of the recorded
+     * values lie.
+     *
+     * The result is the upper bound of the bucket which contains the
+     * percentile, capped by max(). If no values have been recorded, zero is
+     * returned.
+     *
+     * @param percent The percentile to compute, between 0 and 100.
+     */
+    std::chrono::nanoseconds percentile(double percent) const;
+
+};
+
+
+/**
+ * Tracer policy which records a latency_histogram for each connection.
+ *
+ * The histogram is the slot_state of each connection, so recording a call
+ * does not involve any lookup or lock. Query the histograms with
+ * signal::visit_slot_state() (by connection) or signal::visit_slot_states()
+ * (for all connections, keyed by token_id):
+ *
+ *     sig11::signal<void(int), sig11::slot_latency_tracer> signal;
+ *     ...
+ *     signal.visit_slot_states([](sig11::token_id id,
+ *                                 const sig11::latency_histogram &hist) {
+ *         std::cout << id << ": p99=" << hist.percentile(99).count() << "ns\n";
+ *     });
+ *
+ * Mind the size: every connection carries a full histogram of about 4.7 KiB
+ * (see latency_histogram), so a signal with a thousand receivers spends
+ * several megabytes on it. For signals with many receivers, a tracer which
+ * records into a shared histogram (or only into some) is the better
+ * choice.
+ */
+class slot_latency_tracer: public null_tracer
+{
+public:
+    using clock = std::chrono::steady_clock;
+    using slot_state = latency_histogram;
+
+private:
+    detail::slot_start_stack<clock::time_point> m_slot_starts;
+
+public:
+    inline void on_slot_begin(token_id, slot_state&)
+    {
+        m_slot_starts.push(clock::now());
+    }
+
+    inline void on_slot_end(token_id, slot_state &histogram)
+    {
+        clock::time_point start;
+        if (m_slot_starts.pop(start)) {
+            histogram.record(clock::now() - start);
+        }
+    }
+
+};
+
+}
+
+#endif
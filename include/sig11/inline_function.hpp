@@ -0,0 +1,115 @@
+/**********************************************************************
+File name: inline_function.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_INLINE_FUNCTION_H
+#define SIG11_INLINE_FUNCTION_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace sig11 {
+
+template <typename call_t, std::size_t inline_size = 2*sizeof(void*)>
+class inline_function;
+
+/**
+ * A type-erased callable with fixed inline storage and no heap allocation.
+ *
+ * Only trivially copyable callables of at most \a inline_size bytes can be
+ * stored; anything else is rejected at compile time. Typical receivers are
+ * plain functions and lambdas which capture a pointer or two. In return,
+ * inline_function is itself trivially copyable, so that copying it never
+ * allocates and never throws.
+ *
+ * A default constructed inline_function is empty and must not be called.
+ */
+template <typename result_t, typename... arg_ts, std::size_t inline_size>
+class inline_function<result_t(arg_ts...), inline_size>
+{
+public:
+    using call_t = result_t(arg_ts...);
+
+public:
+    /**
+     * Construct an empty inline_function.
+     */
+    inline_function():
+        m_invoke(nullptr)
+    {
+
+    }
+
+    /**
+     * Construct an inline_function which stores a copy of \a callable.
+     */
+    template <typename callable_t,
+              typename = typename std::enable_if<
+                  !std::is_same<typename std::decay<callable_t>::type,
+                                inline_function>::value>::type>
+    inline_function(callable_t &&callable):
+        m_invoke(&invoke_impl<typename std::decay<callable_t>::type>)
+    {
+        using stored_t = typename std::decay<callable_t>::type;
+        static_assert(sizeof(stored_t) <= inline_size,
+                      "callable is too large to be stored inline");
+        static_assert(alignof(stored_t) <= alignof(storage_t),
+                      "callable alignment is too strict to be stored inline");
+        static_assert(std::is_trivially_copyable<stored_t>::value,
+                      "callable must be trivially copyable to be stored inline");
+        new (&m_storage) stored_t(std::forward<callable_t>(callable));
+    }
+
+private:
+    using storage_t = typename std::aligned_storage<inline_size, alignof(void*)>::type;
+
+    storage_t m_storage;
+    result_t (*m_invoke)(storage_t&, arg_ts...);
+
+    template <typename callable_t>
+    static result_t invoke_impl(storage_t &storage, arg_ts... args)
+    {
+        return (*reinterpret_cast<callable_t*>(&storage))(std::forward<arg_ts>(args)...);
+    }
+
+public:
+    inline result_t operator()(arg_ts... args)
+    {
+        return m_invoke(m_storage, std::forward<arg_ts>(args)...);
+    }
+
+    /**
+     * Return true if the inline_function holds a callable.
+     */
+    inline explicit operator bool() const
+    {
+        return m_invoke != nullptr;
+    }
+
+};
+
+}
+
+#endif
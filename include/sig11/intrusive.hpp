@@ -0,0 +1,494 @@
+/**********************************************************************
+File name: intrusive.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_INTRUSIVE_H
+#define SIG11_INTRUSIVE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "sig11/inline_function.hpp"
+
+
+namespace sig11 {
+
+template <typename T>
+class intrusive_signal;
+
+template <typename T>
+class slot;
+
+/**
+ * A slot is a hook which a receiver embeds to be connected to an
+ * intrusive_signal without any heap allocation.
+ *
+ * The slot stores its callable inline; the callable must be trivially
+ * copyable and no larger than #inline_size (a lambda capturing `this` and
+ * another pointer fits). Connecting links the slot into the list of the
+ * signal; when the slot is destroyed, it unlinks itself in O(1). The slot
+ * thus takes the role of both the connection and the connection_guard.
+ *
+ * A slot can be connected to at most one signal at a time. Connecting,
+ * disconnecting and destroying the same slot must not happen concurrently.
+ * Disconnecting (and thus destroying) a slot while another thread invokes
+ * it blocks until that invocation has returned, so the receiver may own the
+ * slot without further synchronization; the invocation must not wait for
+ * the disconnecting thread.
+ *
+ * @see intrusive_signal
+ */
+template <typename result_t, typename... arg_ts>
+class slot<result_t(arg_ts...)>
+{
+public:
+    static_assert(std::is_void<result_t>::value,
+                  "signals with non-void return values are not supported.");
+
+    using call_t = result_t(arg_ts...);
+    using signal_t = intrusive_signal<call_t>;
+
+    static constexpr std::size_t inline_size = 2*sizeof(void*);
+
+public:
+    /**
+     * Construct a disconnected slot which invokes \a receiver.
+     *
+     * @param receiver The callable to store inline in the slot.
+     */
+    template <typename callable_t>
+    explicit slot(callable_t &&receiver):
+        m_receiver(std::forward<callable_t>(receiver)),
+        m_signal(nullptr),
+        m_prev(nullptr),
+        m_next(nullptr),
+        m_generation(0)
+    {
+
+    }
+
+    slot(const slot &ref) = delete;
+    slot &operator=(const slot &ref) = delete;
+    slot(slot &&src) = delete;
+    slot &operator=(slot &&src) = delete;
+
+    /**
+     * Disconnect the slot from its signal, if any.
+     */
+    ~slot()
+    {
+        disconnect();
+    }
+
+private:
+    inline_function<void(const arg_ts&...), inline_size> m_receiver;
+
+    /**
+     * Written with the mutex of the signal held; atomic so that the slot
+     * can check whether it is connected without knowing which mutex to
+     * take.
+     */
+    std::atomic<signal_t*> m_signal;
+
+    /* all of the following are protected by the mutex of m_signal */
+    slot *m_prev;
+    slot *m_next;
+    std::uint64_t m_generation;
+
+public:
+    /**
+     * Return true if the slot is connected to a signal.
+     */
+    inline operator bool() const
+    {
+        return m_signal.load() != nullptr;
+    }
+
+    /**
+     * Disconnect the slot from its signal. If the slot is not connected, this
+     * is a no-op.
+     */
+    void disconnect()
+    {
+        if (signal_t *signal = m_signal.load()) {
+            signal->disconnect(*this);
+        }
+    }
+
+    friend class intrusive_signal<call_t>;
+
+};
+
+
+/**
+ * An intrusive_signal is a signal whose receivers are slot hooks owned by the
+ * receivers themselves.
+ *
+ * Connecting and disconnecting a slot never allocates, and neither does
+ * emitting the signal. All operations are thread-safe with respect to each
+ * other. Receivers may disconnect any slot (including their own) and connect
+ * new slots while the signal is being emitted; slots connected during an
+ * emission are not invoked by that emission. Emission is also re-entrant.
+ *
+ * An emission takes the mutex of the signal once per batch of up to
+ * #batch_size slots, not once per slot.
+ *
+ * The signal must outlive all threads which might disconnect its slots. Slots
+ * still connected when the signal is destroyed are disconnected.
+ */
+template <typename result_t, typename... arg_ts>
+class intrusive_signal<result_t(arg_ts...)>
+{
+public:
+    using call_t = result_t(arg_ts...);
+    using slot_t = slot<call_t>;
+
+    /**
+     * Number of slots which an emission takes from the list at once.
+     */
+    static constexpr std::size_t batch_size = 16;
+
+public:
+    /**
+     * Construct a new signal without any connected slots.
+     */
+    intrusive_signal():
+        m_head(nullptr),
+        m_tail(nullptr),
+        m_frames(nullptr),
+        m_generation(0),
+        m_blocked_disconnects(0)
+    {
+
+    }
+
+    intrusive_signal(const intrusive_signal &ref) = delete;
+    intrusive_signal &operator=(const intrusive_signal &ref) = delete;
+    intrusive_signal(intrusive_signal &&src) = delete;
+    intrusive_signal &operator=(intrusive_signal &&src) = delete;
+
+    ~intrusive_signal()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        slot_t *current = m_head;
+        while (current) {
+            slot_t *next = current->m_next;
+            current->m_signal.store(nullptr);
+            current->m_prev = nullptr;
+            current->m_next = nullptr;
+            current = next;
+        }
+    }
+
+private:
+    /**
+     * State of an emission in progress, so that unlinking a slot can move
+     * the cursor of the emission past it and withdraw it from the current
+     * batch.
+     */
+    struct emit_frame
+    {
+        emit_frame(slot_t *head, std::uint64_t generation, emit_frame *outer):
+            next(head),
+            generation(generation),
+            outer(outer),
+            thread(std::this_thread::get_id()),
+            batch_count(0)
+        {
+
+        }
+
+        slot_t *next;
+        const std::uint64_t generation;
+        emit_frame *outer;
+        const std::thread::id thread;
+
+        /**
+         * The slots of the current batch; written by the emission with the
+         * mutex held.
+         */
+        std::size_t batch_count;
+        slot_t *batch[batch_size];
+
+        /**
+         * The call_state of each slot of the current batch. The emission
+         * and disconnect() race to move a pending slot on; whoever gets it
+         * decides whether it is invoked.
+         */
+        std::atomic<unsigned char> state[batch_size];
+    };
+
+    enum call_state: unsigned char
+    {
+        call_pending,
+        call_running,
+        call_done,
+    };
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_call_done;
+    slot_t *m_head;
+    slot_t *m_tail;
+    emit_frame *m_frames;
+    std::uint64_t m_generation;
+
+    /**
+     * Number of disconnect() calls waiting for a slot to return; only
+     * modified with the mutex held, but read by emissions without it.
+     */
+    std::atomic<std::size_t> m_blocked_disconnects;
+
+    /**
+     * Move the next slots of the emission \a frame into its batch.
+     *
+     * Must be called with the mutex held.
+     *
+     * @return false if there are no slots left for the emission.
+     */
+    bool fill_batch(emit_frame &frame)
+    {
+        std::size_t count = 0;
+        slot_t *current = frame.next;
+        // slots are appended, so all slots after a newer one are newer
+        while (current && count < batch_size &&
+               current->m_generation < frame.generation)
+        {
+            frame.batch[count] = current;
+            frame.state[count].store(call_pending, std::memory_order_relaxed);
+            ++count;
+            current = current->m_next;
+        }
+        frame.next = count < batch_size ? nullptr : current;
+        frame.batch_count = count;
+        return count > 0;
+    }
+
+    /**
+     * Release the batch of \a frame, which also ends a call aborted by an
+     * exception.
+     *
+     * Must be called with the mutex held.
+     */
+    void finish_batch(emit_frame &frame)
+    {
+        frame.batch_count = 0;
+        if (m_blocked_disconnects.load() > 0) {
+            m_call_done.notify_all();
+        }
+    }
+
+    /**
+     * Invoke the slot at \a index of the batch of \a frame, unless it has
+     * been disconnected meanwhile.
+     */
+    void invoke(emit_frame &frame, std::size_t index, const arg_ts&... args)
+    {
+        unsigned char expected = call_pending;
+        if (!frame.state[index].compare_exchange_strong(expected, call_running)) {
+            return;
+        }
+        frame.batch[index]->m_receiver(args...);
+        /* pairs with disconnect(), which registers as blocked before it
+         * checks the state: either it sees call_done or we see it */
+        frame.state[index].store(call_done);
+        if (m_blocked_disconnects.load() > 0) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_call_done.notify_all();
+        }
+    }
+
+    void remove_frame(emit_frame *frame)
+    {
+        emit_frame **iter = &m_frames;
+        while (*iter != frame) {
+            iter = &(*iter)->outer;
+        }
+        *iter = frame->outer;
+    }
+
+    /**
+     * Return true if an emission on another thread is invoking \a receiver
+     * right now.
+     *
+     * Must be called with the mutex held.
+     */
+    bool invoked_elsewhere(const slot_t &receiver) const
+    {
+        const std::thread::id self = std::this_thread::get_id();
+        for (emit_frame *frame = m_frames; frame; frame = frame->outer) {
+            if (frame->thread == self) {
+                continue;
+            }
+            for (std::size_t i = 0; i < frame->batch_count; ++i) {
+                if (frame->batch[i] == &receiver &&
+                        frame->state[i].load() == call_running)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+public:
+    /**
+     * Emit the signal with the given arguments.
+     *
+     * The mutex of the signal is released while the slots are invoked.
+     */
+    void operator()(const arg_ts&... args)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        emit_frame frame(m_head, ++m_generation, m_frames);
+        m_frames = &frame;
+        while (fill_batch(frame)) {
+            lock.unlock();
+            try {
+                // only this thread writes batch and batch_count
+                for (std::size_t i = 0; i < frame.batch_count; ++i) {
+                    invoke(frame, i, args...);
+                }
+            } catch (...) {
+                lock.lock();
+                finish_batch(frame);
+                remove_frame(&frame);
+                throw;
+            }
+            lock.lock();
+            finish_batch(frame);
+        }
+        remove_frame(&frame);
+    }
+
+    /**
+     * Connect a \a receiver slot to the signal.
+     *
+     * If the slot is connected to another signal, it is disconnected from
+     * that signal first. Connecting a slot which is already connected to
+     * this signal is a no-op.
+     *
+     * This function is thread-safe.
+     *
+     * @param receiver The slot to connect.
+     */
+    void connect(slot_t &receiver)
+    {
+        if (receiver.m_signal.load() != this) {
+            receiver.disconnect();
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (receiver.m_signal.load() == this) {
+            return;
+        }
+        receiver.m_signal.store(this);
+        receiver.m_generation = m_generation;
+        receiver.m_prev = m_tail;
+        receiver.m_next = nullptr;
+        if (m_tail) {
+            m_tail->m_next = &receiver;
+        } else {
+            m_head = &receiver;
+        }
+        m_tail = &receiver;
+    }
+
+    /**
+     * Disconnect a \a receiver slot from the signal in O(1).
+     *
+     * If the slot is not connected to this signal, this is a no-op.
+     *
+     * Emissions in progress do not invoke the slot anymore. If an emission
+     * on another thread is invoking it right now, this function blocks
+     * until it has returned.
+     *
+     * This function is thread-safe.
+     *
+     * @param receiver The slot to disconnect.
+     */
+    void disconnect(slot_t &receiver)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (receiver.m_signal.load() != this) {
+            return;
+        }
+
+        for (emit_frame *frame = m_frames; frame; frame = frame->outer) {
+            if (frame->next == &receiver) {
+                frame->next = receiver.m_next;
+            }
+            for (std::size_t i = 0; i < frame->batch_count; ++i) {
+                if (frame->batch[i] == &receiver) {
+                    unsigned char expected = call_pending;
+                    frame->state[i].compare_exchange_strong(expected, call_done);
+                }
+            }
+        }
+
+        if (receiver.m_prev) {
+            receiver.m_prev->m_next = receiver.m_next;
+        } else {
+            m_head = receiver.m_next;
+        }
+        if (receiver.m_next) {
+            receiver.m_next->m_prev = receiver.m_prev;
+        } else {
+            m_tail = receiver.m_prev;
+        }
+        receiver.m_signal.store(nullptr);
+        receiver.m_prev = nullptr;
+        receiver.m_next = nullptr;
+
+        // only wait for the call of this slot, not for the rest of the batch
+        m_blocked_disconnects.fetch_add(1);
+        m_call_done.wait(lock, [this, &receiver](){
+            return !invoked_elsewhere(receiver);
+        });
+        m_blocked_disconnects.fetch_sub(1);
+    }
+
+};
+
+
+template <typename result_t, typename... arg_ts>
+constexpr std::size_t intrusive_signal<result_t(arg_ts...)>::batch_size;
+
+/**
+ * Connect a \a receiver slot to an intrusive \a signal.
+ *
+ * This is the intrusive counterpart to the connect() which returns a
+ * connection_guard: the slot disconnects itself when it is destroyed.
+ */
+template <typename call_t>
+static inline void connect(intrusive_signal<call_t> &signal, slot<call_t> &receiver)
+{
+    signal.connect(receiver);
+}
+
+}
+
+#endif
@@ -0,0 +1,201 @@
+/**********************************************************************
+File name: lock_policy.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_LOCK_POLICY_H
+#define SIG11_LOCK_POLICY_H
+
+#include <atomic>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+
+namespace sig11 {
+
+/**
+ * Locking policy for signals which are only ever used from a single thread.
+ *
+ * All operations are no-ops. A signal using null_mutex must not be accessed
+ * from more than one thread at a time.
+ */
+class null_mutex
+{
+public:
+    inline void lock()
+    {
+
+    }
+
+    inline bool try_lock()
+    {
+        return true;
+    }
+
+    inline void unlock()
+    {
+
+    }
+
+};
+
+
+/**
+ * An adaptive spinlock for very short critical sections.
+ *
+ * lock() spins on a relaxed load (so that waiting threads do not bounce the
+ * cache line) with a CPU pause hint, and starts to yield the time slice once
+ * it has spun for #spin_limit iterations without success.
+ */
+class spin_mutex
+{
+public:
+    static constexpr unsigned spin_limit = 64;
+
+public:
+    spin_mutex():
+        m_locked(false)
+    {
+
+    }
+
+    spin_mutex(const spin_mutex &ref) = delete;
+    spin_mutex &operator=(const spin_mutex &ref) = delete;
+
+private:
+    std::atomic<bool> m_locked;
+
+    static inline void pause()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+#endif
+    }
+
+public:
+    inline bool try_lock()
+    {
+        return !m_locked.load(std::memory_order_relaxed) &&
+               !m_locked.exchange(true, std::memory_order_acquire);
+    }
+
+    inline void lock()
+    {
+        unsigned spins = 0;
+        while (!try_lock()) {
+            while (m_locked.load(std::memory_order_relaxed)) {
+                if (spins < spin_limit) {
+                    ++spins;
+                    pause();
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    inline void unlock()
+    {
+        m_locked.store(false, std::memory_order_release);
+    }
+
+};
+
+
+/**
+ * Reader/writer locking policy: emissions take the lock in shared mode,
+ * connect() and disconnect() in exclusive mode.
+ */
+using shared_mutex = std::shared_timed_mutex;
+
+
+namespace detail {
+
+template <typename mutex_t, typename = void>
+struct has_lock_shared: std::false_type
+{
+};
+
+template <typename mutex_t>
+struct has_lock_shared<mutex_t, decltype(std::declval<mutex_t&>().lock_shared(),
+                                         std::declval<mutex_t&>().unlock_shared(),
+                                         void())>:
+        std::true_type
+{
+};
+
+/**
+ * Scoped lock which takes the mutex in shared mode if it supports that and
+ * in exclusive mode otherwise.
+ */
+template <typename mutex_t, bool shared = has_lock_shared<mutex_t>::value>
+class shared_lock_guard
+{
+public:
+    explicit shared_lock_guard(mutex_t &mutex):
+        m_mutex(mutex)
+    {
+        m_mutex.lock_shared();
+    }
+
+    ~shared_lock_guard()
+    {
+        m_mutex.unlock_shared();
+    }
+
+    shared_lock_guard(const shared_lock_guard &ref) = delete;
+    shared_lock_guard &operator=(const shared_lock_guard &ref) = delete;
+
+private:
+    mutex_t &m_mutex;
+};
+
+template <typename mutex_t>
+class shared_lock_guard<mutex_t, false>
+{
+public:
+    explicit shared_lock_guard(mutex_t &mutex):
+        m_mutex(mutex)
+    {
+        m_mutex.lock();
+    }
+
+    ~shared_lock_guard()
+    {
+        m_mutex.unlock();
+    }
+
+    shared_lock_guard(const shared_lock_guard &ref) = delete;
+    shared_lock_guard &operator=(const shared_lock_guard &ref) = delete;
+
+private:
+    mutex_t &m_mutex;
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,121 @@
+/**********************************************************************
+File name: pod_tuple.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_POD_TUPLE_H
+#define SIG11_POD_TUPLE_H
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+
+namespace sig11 {
+
+namespace detail {
+
+/**
+ * Minimal tuple which is trivially copyable if its elements are (unlike
+ * std::tuple).
+ */
+template <typename... ts>
+struct pod_tuple;
+
+template <>
+struct pod_tuple<>
+{
+};
+
+template <typename T, typename... rest_ts>
+struct pod_tuple<T, rest_ts...>
+{
+    pod_tuple() = default;
+
+    pod_tuple(const T &head, const rest_ts&... rest):
+        head(head),
+        tail(rest...)
+    {
+
+    }
+
+    T head;
+    pod_tuple<rest_ts...> tail;
+};
+
+template <std::size_t index>
+struct pod_get
+{
+    template <typename tuple_t>
+    static inline const auto &get(const tuple_t &tuple)
+    {
+        return pod_get<index-1>::get(tuple.tail);
+    }
+};
+
+template <>
+struct pod_get<0>
+{
+    template <typename tuple_t>
+    static inline const auto &get(const tuple_t &tuple)
+    {
+        return tuple.head;
+    }
+};
+
+template <typename callable_t, typename tuple_t, std::size_t... indices>
+inline void pod_apply(callable_t &&callable, const tuple_t &tuple,
+                      std::index_sequence<indices...>)
+{
+    callable(pod_get<indices>::get(tuple)...);
+}
+
+/**
+ * Call \a callable with the elements of the pod_tuple \a tuple.
+ */
+template <typename callable_t, typename... ts>
+inline void pod_apply(callable_t &&callable, const pod_tuple<ts...> &tuple)
+{
+    pod_apply(std::forward<callable_t>(callable), tuple,
+              std::index_sequence_for<ts...>());
+}
+
+template <typename... ts>
+struct all_trivially_copyable;
+
+template <>
+struct all_trivially_copyable<>: std::true_type
+{
+};
+
+template <typename T, typename... rest_ts>
+struct all_trivially_copyable<T, rest_ts...>: std::integral_constant<
+        bool,
+        std::is_trivially_copyable<T>::value &&
+        all_trivially_copyable<rest_ts...>::value>
+{
+};
+
+}
+
+}
+
+#endif
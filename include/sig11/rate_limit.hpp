@@ -0,0 +1,395 @@
+/**********************************************************************
+File name: rate_limit.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_RATE_LIMIT_H
+#define SIG11_RATE_LIMIT_H
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "sig11/sig11.hpp"
+#include "sig11/timer_wheel.hpp"
+
+
+namespace sig11 {
+
+/**
+ * Edges of a rate limiting window on which the receiver is called.
+ */
+enum class rate_limit_edge
+{
+    /**
+     * Call the receiver with the emission which opens the window.
+     */
+    leading = 1,
+
+    /**
+     * Call the receiver with the last emission of the window once it has
+     * closed.
+     */
+    trailing = 2,
+
+    both = 3,
+};
+
+/**
+ * Rate limiting policy of a connection.
+ *
+ * @see throttle()
+ * @see debounce()
+ * @see max_rate()
+ */
+struct rate_limit
+{
+    enum class kind
+    {
+        /**
+         * Call the receiver at most once per interval.
+         */
+        throttle,
+
+        /**
+         * Call the receiver only once the emissions have paused for an
+         * interval.
+         */
+        debounce,
+    };
+
+    kind mode;
+    timer_wheel::duration interval;
+    rate_limit_edge edge;
+
+    inline bool leading() const
+    {
+        return (static_cast<unsigned>(edge) & static_cast<unsigned>(rate_limit_edge::leading)) != 0;
+    }
+
+    inline bool trailing() const
+    {
+        return (static_cast<unsigned>(edge) & static_cast<unsigned>(rate_limit_edge::trailing)) != 0;
+    }
+};
+
+/**
+ * Call the receiver at most once per \a interval.
+ *
+ * With the leading edge, the first emission of a window is passed on right
+ * away; with the trailing edge, the last emission of a window is passed on
+ * when it closes (which opens the next window).
+ */
+template <typename rep_t, typename period_t>
+static inline rate_limit throttle(std::chrono::duration<rep_t, period_t> interval,
+                                  rate_limit_edge edge = rate_limit_edge::both)
+{
+    return rate_limit{rate_limit::kind::throttle,
+                      std::chrono::duration_cast<timer_wheel::duration>(interval),
+                      edge};
+}
+
+/**
+ * Call the receiver once the emissions have paused for \a interval.
+ *
+ * With the leading edge, the first emission after a pause is passed on
+ * right away; with the trailing edge, the last emission before a pause is
+ * passed on when the pause has lasted \a interval.
+ */
+template <typename rep_t, typename period_t>
+static inline rate_limit debounce(std::chrono::duration<rep_t, period_t> interval,
+                                  rate_limit_edge edge = rate_limit_edge::trailing)
+{
+    return rate_limit{rate_limit::kind::debounce,
+                      std::chrono::duration_cast<timer_wheel::duration>(interval),
+                      edge};
+}
+
+/**
+ * Call the receiver at most \a count times per \a period, passing on the
+ * latest emission at the end of each window.
+ *
+ * @throws std::invalid_argument if \a count is zero.
+ */
+template <typename rep_t, typename period_t>
+static inline rate_limit max_rate(unsigned count, std::chrono::duration<rep_t, period_t> period)
+{
+    if (count == 0) {
+        throw std::invalid_argument("max_rate needs a count of at least one");
+    }
+    return throttle(std::chrono::duration_cast<timer_wheel::duration>(period) / count);
+}
+
+
+namespace detail {
+
+/**
+ * State of a rate limited connection, shared between the signal (which
+ * calls it from the dispatch loop) and the timer_wheel (which closes the
+ * windows).
+ */
+template <typename receiver_t, typename... arg_ts>
+class rate_limiter
+{
+public:
+    rate_limiter(timer_wheel &wheel, const rate_limit &limit, receiver_t &&receiver):
+        m_wheel(wheel),
+        m_limit(limit),
+        m_receiver(std::move(receiver)),
+        m_closed(false),
+        m_calls(0),
+        m_has_pending(false)
+    {
+
+    }
+
+    rate_limiter(const rate_limiter &ref) = delete;
+    rate_limiter &operator=(const rate_limiter &ref) = delete;
+    rate_limiter(rate_limiter &&src) = delete;
+    rate_limiter &operator=(rate_limiter &&src) = delete;
+
+    ~rate_limiter()
+    {
+        timer_handle timer;
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_closed = true;
+            // a trailing call may still be running in the thread of the
+            // wheel, after it has opened the next window
+            m_idle.wait(lock, [this](){ return m_calls == 0; });
+            timer = m_timer;
+        }
+        // waits for a window which is being closed right now
+        m_wheel.cancel(timer);
+        clear_pending();
+    }
+
+private:
+    using args_type = std::tuple<typename std::decay<arg_ts>::type...>;
+
+    std::mutex m_lock;
+    std::condition_variable m_idle;
+    timer_wheel &m_wheel;
+    const rate_limit m_limit;
+
+    /**
+     * Serializes the calls of the receiver; recursive, as a receiver may
+     * emit the signal it is connected to.
+     */
+    std::recursive_mutex m_call_mutex;
+    receiver_t m_receiver;
+
+    bool m_closed;
+
+    /**
+     * Number of receiver calls in progress.
+     */
+    std::size_t m_calls;
+
+    /**
+     * The timer which closes the current window, if a window is open.
+     */
+    timer_handle m_timer;
+
+    /**
+     * End of the current debounce window; each emission pushes it back.
+     */
+    timer_wheel::time_point m_deadline;
+
+    /**
+     * Arguments for the trailing edge call.
+     */
+    bool m_has_pending;
+    typename std::aligned_storage<sizeof(args_type), alignof(args_type)>::type m_pending;
+
+    inline args_type &pending()
+    {
+        return *reinterpret_cast<args_type*>(&m_pending);
+    }
+
+    void set_pending(const arg_ts&... args)
+    {
+        if (m_has_pending) {
+            pending() = args_type(args...);
+        } else {
+            new (&m_pending) args_type(args...);
+            m_has_pending = true;
+        }
+    }
+
+    void clear_pending()
+    {
+        if (m_has_pending) {
+            pending().~args_type();
+            m_has_pending = false;
+        }
+    }
+
+    /**
+     * Accounts for a receiver call; constructed with m_lock held, which it
+     * releases, and destructed without it.
+     */
+    class call_guard
+    {
+    public:
+        call_guard(rate_limiter &owner, std::unique_lock<std::mutex> &lock):
+            m_owner(owner)
+        {
+            ++m_owner.m_calls;
+            lock.unlock();
+        }
+
+        ~call_guard()
+        {
+            std::lock_guard<std::mutex> lock(m_owner.m_lock);
+            if (--m_owner.m_calls == 0) {
+                m_owner.m_idle.notify_all();
+            }
+        }
+
+    private:
+        rate_limiter &m_owner;
+    };
+
+    template <std::size_t... indices>
+    inline void call(args_type &args, std::index_sequence<indices...>)
+    {
+        std::lock_guard<std::recursive_mutex> serial(m_call_mutex);
+        m_receiver(std::get<indices>(args)...);
+    }
+
+    static void close_window(void *context)
+    {
+        static_cast<rate_limiter*>(context)->on_window_closed();
+    }
+
+    void on_window_closed()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_timer = timer_handle();
+        if (m_closed) {
+            return;
+        }
+        if (m_limit.mode == rate_limit::kind::debounce && m_wheel.now() < m_deadline) {
+            // emissions have arrived since the timer was set
+            m_timer = m_wheel.schedule_at(m_deadline, &close_window, this);
+            return;
+        }
+        if (!m_has_pending) {
+            return;
+        }
+
+        args_type args(std::move(pending()));
+        clear_pending();
+        if (m_limit.mode == rate_limit::kind::throttle) {
+            // the trailing call opens the next window
+            m_timer = m_wheel.schedule_after(m_limit.interval, &close_window, this);
+        }
+        call_guard guard(*this, lock);
+        call(args, std::index_sequence_for<arg_ts...>());
+    }
+
+public:
+    void operator()(const arg_ts&... args)
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        const bool open = bool(m_timer);
+        if (m_limit.mode == rate_limit::kind::debounce) {
+            m_deadline = m_wheel.now() + m_limit.interval;
+        }
+        if (!open) {
+            m_timer = m_wheel.schedule_after(m_limit.interval, &close_window, this);
+            if (m_limit.leading()) {
+                call_guard guard(*this, lock);
+                std::lock_guard<std::recursive_mutex> serial(m_call_mutex);
+                m_receiver(args...);
+                return;
+            }
+        }
+        if (m_limit.trailing()) {
+            set_pending(args...);
+        }
+    }
+
+};
+
+/**
+ * Copyable receiver which forwards to a shared rate_limiter.
+ */
+template <typename limiter_t>
+struct rate_limited_receiver
+{
+    std::shared_ptr<limiter_t> limiter;
+
+    template <typename... arg_ts>
+    inline void operator()(const arg_ts&... args) const
+    {
+        (*limiter)(args...);
+    }
+};
+
+}
+
+
+/**
+ * Connect a \a receiver to a \a signal, with the rate of calls limited by
+ * \a limit.
+ *
+ * The limit is enforced in the dispatch loop of the signal: emissions which
+ * fall into a window are dropped or kept for the trailing edge call,
+ * without calling the receiver. Windows are closed by timers on the shared
+ * \a wheel, so that no thread and no timer of its own is needed per
+ * receiver. Intervals are measured in the time of the wheel.
+ *
+ * Leading edge calls happen in the emitting thread, trailing edge calls in
+ * the thread which advances the \a wheel. The calls are serialized, so the
+ * receiver never runs on two threads at once. Destroying the connection
+ * waits for a trailing edge call which is in progress on another thread.
+ * The \a wheel must outlive the connection, and a trailing edge call must
+ * not disconnect its own connection.
+ *
+ * It returns a connection_guard for the new connection.
+ */
+template <typename result_t, typename... arg_ts, typename tracer_t, typename mutex_t,
+          typename callable_t>
+static inline connection_guard<result_t(arg_ts...)> connect_rate_limited [[gnu::warn_unused_result]] (
+        signal<result_t(arg_ts...), tracer_t, mutex_t> &signal,
+        timer_wheel &wheel,
+        const rate_limit &limit,
+        callable_t &&receiver)
+{
+    using limiter_t = detail::rate_limiter<typename std::decay<callable_t>::type, arg_ts...>;
+    typename std::decay<callable_t>::type stored(std::forward<callable_t>(receiver));
+    return connection_guard<result_t(arg_ts...)>(
+                signal.connect(detail::rate_limited_receiver<limiter_t>{
+                                   std::make_shared<limiter_t>(wheel, limit, std::move(stored))}),
+                signal);
+}
+
+}
+
+#endif
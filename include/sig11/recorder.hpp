@@ -0,0 +1,438 @@
+/**********************************************************************
+File name: recorder.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_RECORDER_H
+#define SIG11_RECORDER_H
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+#include "sig11/lock_policy.hpp"
+#include "sig11/pod_tuple.hpp"
+#include "sig11/sig11.hpp"
+
+
+namespace sig11 {
+
+namespace detail {
+
+/**
+ * A file which is mapped into the address space as a whole.
+ */
+class mapped_file
+{
+public:
+    /**
+     * Create (or truncate) the file at \a path with \a size bytes and map
+     * it for reading and writing.
+     *
+     * @throws std::system_error on failure.
+     */
+    mapped_file(const std::string &path, std::size_t size);
+
+    /**
+     * Map the existing file at \a path for reading.
+     *
+     * @throws std::system_error on failure.
+     */
+    explicit mapped_file(const std::string &path);
+
+    ~mapped_file();
+
+    mapped_file(const mapped_file &ref) = delete;
+    mapped_file &operator=(const mapped_file &ref) = delete;
+    mapped_file(mapped_file &&src) = delete;
+    mapped_file &operator=(mapped_file &&src) = delete;
+
+private:
+    const int m_fd;
+    const bool m_writable;
+    std::size_t m_size;
+    void *m_data;
+
+public:
+    inline void *data() const
+    {
+        return m_data;
+    }
+
+    inline std::size_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * Change the size of a writable file; the mapping may move.
+     *
+     * @throws std::system_error on failure.
+     */
+    void resize(std::size_t size);
+
+};
+
+/**
+ * Layout of an emission log: this header, followed by the records.
+ */
+struct log_header
+{
+    static constexpr std::uint64_t magic_value = 0x7369673131726331ULL;
+
+    std::uint64_t magic;
+    std::uint64_t payload_size;
+    std::uint64_t record_size;
+
+    /**
+     * Number of complete records in the log.
+     */
+    std::uint64_t count;
+
+    /**
+     * Wall clock time of the start of the recording, in nanoseconds since
+     * the UNIX epoch.
+     */
+    std::int64_t start_time_ns;
+};
+
+template <typename payload_t>
+struct log_record
+{
+    /**
+     * Time of the emission, in nanoseconds since the start of the
+     * recording.
+     */
+    std::int64_t timestamp_ns;
+    payload_t payload;
+};
+
+}
+
+
+/**
+ * Pace at which emission_log::replay() re-emits a recording.
+ */
+enum class replay_speed
+{
+    /**
+     * Keep the original time between the emissions.
+     */
+    original,
+
+    /**
+     * Emit the records back to back.
+     */
+    maximum,
+};
+
+
+template <typename T>
+class emission_recorder;
+
+template <typename T>
+class emission_log;
+
+
+/**
+ * Receiver which records every emission into an append-only, memory-mapped
+ * binary log, for offline replay with emission_log.
+ *
+ * Each record consists of a timestamp (relative to the creation of the
+ * recorder) and a copy of the trivially copyable arguments. Appending a
+ * record is a clock read and a copy into the mapping; the file grows by
+ * doubling, so only a logarithmic number of appends remap it. The record
+ * count in the file header is updated with every record, so that a log is
+ * readable up to the last complete record even if the process dies.
+ *
+ * A recorder may be connected to several signals, which may be emitted
+ * from different threads. Appends are serialized by a spin lock; growing
+ * the file (ftruncate() and mremap()) happens outside of it, under a
+ * blocking mutex on which other appenders sleep until there is room again.
+ * When the recorder is destroyed, the file is truncated to the recorded
+ * size.
+ */
+template <typename result_t, typename... arg_ts>
+class emission_recorder<result_t(arg_ts...)>
+{
+public:
+    static_assert(detail::all_trivially_copyable<arg_ts...>::value,
+                  "recorded arguments must be trivially copyable");
+
+    using call_t = result_t(arg_ts...);
+    using payload_type = detail::pod_tuple<typename std::decay<arg_ts>::type...>;
+
+public:
+    /**
+     * Create (or truncate) the log file at \a path with initial room for
+     * \a capacity records.
+     *
+     * @throws std::system_error if the file cannot be created.
+     */
+    explicit emission_recorder(const std::string &path, std::size_t capacity = 4096):
+        m_file(path, sizeof(detail::log_header) + std::max<std::size_t>(capacity, 1) * sizeof(record)),
+        m_start(std::chrono::steady_clock::now()),
+        m_count(0)
+    {
+        update_mapping();
+        detail::log_header *header = m_header;
+        header->magic = detail::log_header::magic_value;
+        header->payload_size = sizeof(payload_type);
+        header->record_size = sizeof(record);
+        header->count = 0;
+        header->start_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    emission_recorder(const emission_recorder &ref) = delete;
+    emission_recorder &operator=(const emission_recorder &ref) = delete;
+    emission_recorder(emission_recorder &&src) = delete;
+    emission_recorder &operator=(emission_recorder &&src) = delete;
+
+    ~emission_recorder()
+    {
+        try {
+            m_file.resize(sizeof(detail::log_header) + m_count * sizeof(record));
+        } catch (const std::system_error&) {
+            // the log is still valid, only with trailing unused space
+        }
+    }
+
+private:
+    using record = detail::log_record<payload_type>;
+
+    /**
+     * Protects m_count and the mapping as seen by appenders (m_header,
+     * m_records and m_capacity).
+     */
+    mutable spin_mutex m_lock;
+
+    /**
+     * Serializes growing the file; m_file is only touched with it held.
+     */
+    std::mutex m_grow_mutex;
+
+    detail::mapped_file m_file;
+    const std::chrono::steady_clock::time_point m_start;
+    std::size_t m_count;
+    detail::log_header *m_header;
+    record *m_records;
+    std::size_t m_capacity;
+
+    void update_mapping()
+    {
+        m_header = static_cast<detail::log_header*>(m_file.data());
+        m_records = reinterpret_cast<record*>(
+                    static_cast<char*>(m_file.data()) + sizeof(detail::log_header));
+        m_capacity = (m_file.size() - sizeof(detail::log_header)) / sizeof(record);
+    }
+
+    /**
+     * Double the size of the file, unless another thread made room in the
+     * meantime.
+     *
+     * While the log is full, no appender touches the mapping, so it can be
+     * moved without holding m_lock.
+     */
+    void grow()
+    {
+        std::lock_guard<std::mutex> grow_lock(m_grow_mutex);
+        std::size_t count;
+        {
+            std::lock_guard<spin_mutex> lock(m_lock);
+            if (m_count < m_capacity) {
+                return;
+            }
+            count = m_count;
+        }
+        m_file.resize(sizeof(detail::log_header) + 2 * count * sizeof(record));
+        std::lock_guard<spin_mutex> lock(m_lock);
+        update_mapping();
+    }
+
+public:
+    /**
+     * Append a record for an emission with the given arguments.
+     *
+     * @throws std::system_error if the file cannot be grown.
+     */
+    void operator()(const arg_ts&... args)
+    {
+        record rec;
+        rec.payload = payload_type(args...);
+
+        for (;;) {
+            {
+                std::lock_guard<spin_mutex> lock(m_lock);
+                if (m_count < m_capacity) {
+                    rec.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now() - m_start).count();
+                    std::memcpy(&m_records[m_count], &rec, sizeof(rec));
+                    ++m_count;
+                    m_header->count = m_count;
+                    return;
+                }
+            }
+            grow();
+        }
+    }
+
+    /**
+     * The number of records written so far.
+     *
+     * This function is thread-safe.
+     */
+    std::size_t size() const
+    {
+        std::lock_guard<spin_mutex> lock(m_lock);
+        return m_count;
+    }
+
+};
+
+
+/**
+ * Read-only view of a log written by emission_recorder, which can replay
+ * the recorded emissions into a signal.
+ */
+template <typename result_t, typename... arg_ts>
+class emission_log<result_t(arg_ts...)>
+{
+public:
+    using call_t = result_t(arg_ts...);
+    using payload_type = typename emission_recorder<call_t>::payload_type;
+
+public:
+    /**
+     * Map the log file at \a path.
+     *
+     * @throws std::system_error if the file cannot be mapped.
+     * @throws std::runtime_error if the file is not a log with the same
+     * argument layout.
+     */
+    explicit emission_log(const std::string &path):
+        m_file(path),
+        m_count(0)
+    {
+        const detail::log_header *header = static_cast<const detail::log_header*>(m_file.data());
+        if (m_file.size() < sizeof(detail::log_header) ||
+                header->magic != detail::log_header::magic_value ||
+                header->payload_size != sizeof(payload_type) ||
+                header->record_size != sizeof(record))
+        {
+            throw std::runtime_error("not a matching sig11 emission log: " + path);
+        }
+        m_count = std::min<std::size_t>(
+                    header->count,
+                    (m_file.size() - sizeof(detail::log_header)) / sizeof(record));
+    }
+
+private:
+    using record = detail::log_record<payload_type>;
+
+    detail::mapped_file m_file;
+    std::size_t m_count;
+
+    inline record read(std::size_t index) const
+    {
+        record result;
+        std::memcpy(&result,
+                    static_cast<const char*>(m_file.data()) + sizeof(detail::log_header) +
+                        index * sizeof(record),
+                    sizeof(record));
+        return result;
+    }
+
+public:
+    /**
+     * The number of records in the log.
+     */
+    inline std::size_t size() const
+    {
+        return m_count;
+    }
+
+    /**
+     * The time of the record \a index since the start of the recording.
+     */
+    std::chrono::nanoseconds timestamp(std::size_t index) const
+    {
+        return std::chrono::nanoseconds(read(index).timestamp_ns);
+    }
+
+    /**
+     * Re-emit all records on \a signal (any callable with the recorded
+     * signature), either with the recorded spacing or back to back.
+     *
+     * @return The number of emissions.
+     */
+    template <typename signal_t>
+    std::size_t replay(signal_t &signal, replay_speed speed = replay_speed::original) const
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < m_count; ++i) {
+            const record rec = read(i);
+            if (speed == replay_speed::original) {
+                std::this_thread::sleep_until(start + std::chrono::nanoseconds(rec.timestamp_ns));
+            }
+            detail::pod_apply(signal, rec.payload);
+        }
+        return m_count;
+    }
+
+};
+
+
+/**
+ * Connect the \a recorder to a \a signal with a matching signature.
+ *
+ * The recorder is connected by reference and must outlive the connection.
+ *
+ * It returns a connection_guard for the new connection.
+ */
+template <typename result_t, typename... arg_ts, typename tracer_t, typename mutex_t>
+static inline connection_guard<result_t(arg_ts...)> connect [[gnu::warn_unused_result]] (
+        signal<result_t(arg_ts...), tracer_t, mutex_t> &signal,
+        emission_recorder<result_t(arg_ts...)> &recorder)
+{
+    emission_recorder<result_t(arg_ts...)> *target = &recorder;
+    return connection_guard<result_t(arg_ts...)>(
+                signal.connect([target](const arg_ts&... args){
+                    (*target)(args...);
+                }),
+                signal);
+}
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,321 @@
+/**********************************************************************
+File name: registry.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_REGISTRY_H
+#define SIG11_REGISTRY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "sig11/tracer.hpp"
+
+
+namespace sig11 {
+
+class signal_registry;
+
+/**
+ * Counters which describe a single signal.
+ *
+ * All counters are updated with relaxed atomic operations, so that they can
+ * be maintained on the emission path without locking.
+ */
+class signal_metrics
+{
+public:
+    explicit signal_metrics(std::string name);
+
+    signal_metrics(const signal_metrics &ref) = delete;
+    signal_metrics &operator=(const signal_metrics &ref) = delete;
+
+private:
+    const std::string m_name;
+    std::atomic<std::uint64_t> m_listeners;
+    std::atomic<std::uint64_t> m_emits;
+    std::atomic<std::uint64_t> m_slot_time_ns;
+
+public:
+    inline const std::string &name() const
+    {
+        return m_name;
+    }
+
+    inline std::uint64_t listeners() const
+    {
+        return m_listeners.load(std::memory_order_relaxed);
+    }
+
+    inline std::uint64_t emits() const
+    {
+        return m_emits.load(std::memory_order_relaxed);
+    }
+
+    inline std::chrono::nanoseconds slot_time() const
+    {
+        return std::chrono::nanoseconds(m_slot_time_ns.load(std::memory_order_relaxed));
+    }
+
+    inline void add_listener()
+    {
+        m_listeners.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline void remove_listener()
+    {
+        m_listeners.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    inline void add_emit()
+    {
+        m_emits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline void add_slot_time(std::chrono::nanoseconds elapsed)
+    {
+        m_slot_time_ns.fetch_add(elapsed.count(), std::memory_order_relaxed);
+    }
+
+};
+
+
+/**
+ * A registry of named signals which can export the metrics of all of its
+ * signals as a text snapshot.
+ *
+ * Signals register through the metrics_tracer. Registration and
+ * unregistration take the mutex of the registry; the emission path does not.
+ *
+ * Several signals may register under the same name. Each of them gets the
+ * lowest index which no other registered signal of that name has, and the
+ * exports distinguish the signals by an `index` label (Prometheus) or
+ * field (JSON) if it is not zero. Signals with unique names thus export
+ * without it.
+ *
+ * Use instance() for the process-wide registry.
+ */
+class signal_registry
+{
+public:
+    /**
+     * A point-in-time copy of the metrics of one signal.
+     */
+    struct sample
+    {
+        std::string name;
+
+        /**
+         * Distinguishes signals registered under the same name.
+         */
+        unsigned index;
+
+        std::uint64_t listeners;
+        std::uint64_t emits;
+        std::chrono::nanoseconds slot_time;
+    };
+
+public:
+    signal_registry() = default;
+    signal_registry(const signal_registry &ref) = delete;
+    signal_registry &operator=(const signal_registry &ref) = delete;
+
+private:
+    struct entry
+    {
+        const signal_metrics *metrics;
+        unsigned index;
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<entry> m_signals;
+
+public:
+    /**
+     * The process-wide registry.
+     */
+    static signal_registry &instance();
+
+    /**
+     * Add \a metrics to the registry. The metrics must be removed with
+     * unregister_signal() before they are destroyed.
+     */
+    void register_signal(const signal_metrics &metrics);
+
+    /**
+     * Remove \a metrics from the registry.
+     */
+    void unregister_signal(const signal_metrics &metrics);
+
+    /**
+     * Return a copy of the metrics of all registered signals, in
+     * registration order.
+     */
+    std::vector<sample> snapshot() const;
+
+    /**
+     * Write a snapshot in the Prometheus text exposition format.
+     */
+    void write_prometheus(std::ostream &out) const;
+
+    /**
+     * Write a snapshot as a JSON array of objects.
+     */
+    void write_json(std::ostream &out) const;
+
+    /**
+     * Return a snapshot in the Prometheus text exposition format.
+     */
+    std::string to_prometheus() const;
+
+    /**
+     * Return a snapshot as a JSON array of objects.
+     */
+    std::string to_json() const;
+
+    /**
+     * Write a snapshot in the Prometheus text exposition format to the file
+     * at \a path.
+     *
+     * The snapshot is written to a temporary file next to \a path first and
+     * then renamed, so that readers never see a partial snapshot.
+     *
+     * @return true on success.
+     */
+    bool write_prometheus_file(const std::string &path) const;
+
+    /**
+     * Write a snapshot as JSON to the file at \a path; see
+     * write_prometheus_file().
+     *
+     * @return true on success.
+     */
+    bool write_json_file(const std::string &path) const;
+
+};
+
+
+/**
+ * Tracer policy which registers the signal under a name with a
+ * signal_registry and maintains its signal_metrics.
+ *
+ * The metrics consist of the number of connected receivers, the number of
+ * emissions and the cumulative time spent in receivers. A receiver which
+ * emits the signal again is only accounted for the time outside of the
+ * nested receiver calls, so that no time is counted twice.
+ *
+ *     sig11::signal<void(int), sig11::metrics_tracer> signal("orders.filled");
+ *     ...
+ *     sig11::signal_registry::instance().write_prometheus_file("/run/metrics.prom");
+ */
+class metrics_tracer: public null_tracer
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+public:
+    /**
+     * Register the signal as \a name with the process-wide registry.
+     */
+    explicit metrics_tracer(std::string name);
+
+    /**
+     * Register the signal as \a name with \a registry, which must outlive the
+     * tracer.
+     */
+    metrics_tracer(std::string name, signal_registry &registry);
+
+    ~metrics_tracer();
+
+    metrics_tracer(const metrics_tracer &ref) = delete;
+    metrics_tracer &operator=(const metrics_tracer &ref) = delete;
+
+private:
+    /**
+     * A receiver call in progress.
+     */
+    struct slot_call
+    {
+        clock::time_point start;
+
+        /**
+         * Time spent in nested receiver calls so far.
+         */
+        clock::duration nested;
+    };
+
+    signal_registry &m_registry;
+    signal_metrics m_metrics;
+    detail::slot_start_stack<slot_call> m_calls;
+
+public:
+    template <typename slot_state_t>
+    inline void on_connect(token_id, slot_state_t&)
+    {
+        m_metrics.add_listener();
+    }
+
+    template <typename slot_state_t>
+    inline void on_disconnect(token_id, slot_state_t&)
+    {
+        m_metrics.remove_listener();
+    }
+
+    inline void on_emit_begin()
+    {
+        m_metrics.add_emit();
+    }
+
+    template <typename slot_state_t>
+    inline void on_slot_begin(token_id, slot_state_t&)
+    {
+        m_calls.push(slot_call{clock::now(), clock::duration::zero()});
+    }
+
+    template <typename slot_state_t>
+    inline void on_slot_end(token_id, slot_state_t&)
+    {
+        slot_call call;
+        if (!m_calls.pop(call)) {
+            return;
+        }
+        const clock::duration elapsed = clock::now() - call.start;
+        m_metrics.add_slot_time(elapsed - call.nested);
+        if (slot_call *outer = m_calls.top()) {
+            outer->nested += elapsed;
+        }
+    }
+
+    inline const signal_metrics &metrics() const
+    {
+        return m_metrics;
+    }
+
+};
+
+}
+
+#endif
@@ -0,0 +1,456 @@
+/**********************************************************************
+File name: shm_signal.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_SHM_SIGNAL_H
+#define SIG11_SHM_SIGNAL_H
+
+#ifdef __linux__
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <sys/types.h>
+
+#include "sig11/pod_tuple.hpp"
+#include "sig11/sig11.hpp"
+
+
+namespace sig11 {
+
+namespace detail {
+
+/**
+ * A shared memory object (shm_open()) mapped into the address space.
+ */
+class shm_region
+{
+public:
+    /**
+     * Create the shared memory object \a name with \a size bytes.
+     *
+     * An existing object of that name is unlinked, not reused: processes
+     * which still have it mapped keep their (now anonymous) object. The
+     * object is unlinked when the region is destroyed, unless the name has
+     * been taken over by another object in the meantime.
+     *
+     * @throws std::system_error on failure.
+     */
+    shm_region(const std::string &name, std::size_t size);
+
+    /**
+     * Map the existing shared memory object \a name.
+     *
+     * @throws std::system_error on failure.
+     */
+    explicit shm_region(const std::string &name);
+
+    ~shm_region();
+
+    shm_region(const shm_region &ref) = delete;
+    shm_region &operator=(const shm_region &ref) = delete;
+    shm_region(shm_region &&src) = delete;
+    shm_region &operator=(shm_region &&src) = delete;
+
+private:
+    const std::string m_name;
+    const bool m_owner;
+    dev_t m_device;
+    ino_t m_inode;
+    std::size_t m_size;
+    void *m_data;
+
+    bool names_this_object() const;
+
+public:
+    inline void *data() const
+    {
+        return m_data;
+    }
+
+    inline std::size_t size() const
+    {
+        return m_size;
+    }
+
+};
+
+/**
+ * Wait until \a word no longer contains \a expected, a wakeup is sent or
+ * the \a timeout expires. Works across processes.
+ */
+void futex_wait(std::atomic<std::uint32_t> &word, std::uint32_t expected,
+                std::chrono::nanoseconds timeout);
+
+/**
+ * Wake all waiters on \a word, in any process.
+ */
+void futex_wake_all(std::atomic<std::uint32_t> &word);
+
+/**
+ * Layout of the shared memory of a shm_signal: this header, followed by
+ * the ring of records.
+ */
+struct shm_header
+{
+    static constexpr std::uint64_t magic_value = 0x7369673131736d31ULL;
+
+    std::atomic<std::uint64_t> magic;
+    std::uint64_t payload_size;
+    std::uint64_t capacity;
+
+    /**
+     * Number of records written so far.
+     */
+    std::atomic<std::uint64_t> write_seq;
+
+    /**
+     * Futex word which is bumped to wake up subscribers.
+     */
+    std::atomic<std::uint32_t> wake_seq;
+
+    /**
+     * Number of subscribers which are about to sleep on wake_seq.
+     *
+     * A subscriber process which dies inside shm_subscriber::wait() never
+     * decrements it. This only costs performance: every later emission
+     * makes a futex wake system call, until the shm_signal is recreated.
+     */
+    std::atomic<std::uint32_t> sleepers;
+};
+
+template <typename payload_t>
+struct shm_record
+{
+    /**
+     * Seqlock: 2n+1 while record n is written, 2n+2 once it is complete.
+     */
+    std::atomic<std::uint64_t> seq;
+    payload_t payload;
+};
+
+template <typename payload_t>
+struct shm_layout
+{
+    static constexpr std::size_t cache_line_size = 64;
+    static constexpr std::size_t records_offset =
+            (sizeof(shm_header) + cache_line_size - 1) / cache_line_size * cache_line_size;
+
+    static inline std::size_t size(std::size_t capacity)
+    {
+        return records_offset + capacity * sizeof(shm_record<payload_t>);
+    }
+
+    static inline shm_header *header(void *base)
+    {
+        return static_cast<shm_header*>(base);
+    }
+
+    static inline shm_record<payload_t> *records(void *base)
+    {
+        return reinterpret_cast<shm_record<payload_t>*>(
+                    static_cast<char*>(base) + records_offset);
+    }
+};
+
+}
+
+
+template <typename T>
+class shm_signal;
+
+template <typename T>
+class shm_subscriber;
+
+
+/**
+ * The emitting end of a signal which crosses process boundaries on one
+ * host.
+ *
+ * The signal owns a named POSIX shared memory object which holds a ring of
+ * #capacity() records. Each emission copies the arguments into the next
+ * record and publishes it; shm_subscriber objects in other processes (or
+ * the same one) then read the records directly from the shared memory. No
+ * socket and no serialization is involved, and emitting only makes a
+ * system call (a futex wake) if a subscriber is asleep in
+ * shm_subscriber::wait().
+ *
+ * The ring is a broadcast ring: the emitter never waits for subscribers. A
+ * subscriber which falls behind by more than the capacity loses the oldest
+ * records and counts them (see shm_subscriber::lost()).
+ *
+ * The argument types must be trivially copyable. As with signal, no two
+ * threads must emit a shm_signal without synchronization. The shared
+ * memory object is removed when the shm_signal is destroyed.
+ */
+template <typename result_t, typename... arg_ts>
+class shm_signal<result_t(arg_ts...)>
+{
+public:
+    static_assert(std::is_void<result_t>::value,
+                  "signals with non-void return values are not supported.");
+    static_assert(detail::all_trivially_copyable<arg_ts...>::value,
+                  "shm_signal arguments must be trivially copyable");
+
+    using call_t = result_t(arg_ts...);
+    using payload_type = detail::pod_tuple<typename std::decay<arg_ts>::type...>;
+
+public:
+    /**
+     * Create the shared memory object \a name (as for shm_open(), e.g.
+     * "/my-signal") with room for at least \a capacity records.
+     *
+     * An existing object of that name, for example one left behind by a
+     * crashed process, is replaced by a new one. Subscribers of the old
+     * object are not moved over; they stay attached to the old ring.
+     *
+     * @throws std::system_error if the object cannot be created.
+     */
+    shm_signal(const std::string &name, std::size_t capacity):
+        m_capacity(round_capacity(capacity)),
+        m_region(name, layout::size(m_capacity)),
+        m_header(layout::header(m_region.data())),
+        m_records(layout::records(m_region.data()))
+    {
+        m_header->payload_size = sizeof(payload_type);
+        m_header->capacity = m_capacity;
+        m_header->write_seq.store(0, std::memory_order_relaxed);
+        m_header->wake_seq.store(0, std::memory_order_relaxed);
+        m_header->sleepers.store(0, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < m_capacity; ++i) {
+            m_records[i].seq.store(0, std::memory_order_relaxed);
+        }
+        m_header->magic.store(detail::shm_header::magic_value,
+                              std::memory_order_release);
+    }
+
+    shm_signal(const shm_signal &ref) = delete;
+    shm_signal &operator=(const shm_signal &ref) = delete;
+    shm_signal(shm_signal &&src) = delete;
+    shm_signal &operator=(shm_signal &&src) = delete;
+
+private:
+    using layout = detail::shm_layout<payload_type>;
+    using record = detail::shm_record<payload_type>;
+
+    const std::size_t m_capacity;
+    detail::shm_region m_region;
+    detail::shm_header *const m_header;
+    record *const m_records;
+
+    static std::size_t round_capacity(std::size_t capacity)
+    {
+        std::size_t result = 2;
+        while (result < capacity) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+public:
+    /**
+     * Publish an emission with the given arguments to all subscribers.
+     */
+    void operator()(const arg_ts&... args)
+    {
+        const payload_type payload(args...);
+        const std::uint64_t n = m_header->write_seq.load(std::memory_order_relaxed);
+        record &rec = m_records[n & (m_capacity - 1)];
+
+        rec.seq.store(2*n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&rec.payload, &payload, sizeof(payload));
+        rec.seq.store(2*n + 2, std::memory_order_release);
+
+        m_header->write_seq.store(n + 1);
+        if (m_header->sleepers.load() > 0) {
+            m_header->wake_seq.fetch_add(1);
+            detail::futex_wake_all(m_header->wake_seq);
+        }
+    }
+
+    /**
+     * The number of records in the ring.
+     */
+    inline std::size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+};
+
+
+/**
+ * The receiving end of a shm_signal.
+ *
+ * A subscriber maps the shared memory object of a shm_signal and keeps its
+ * own read cursor, starting at the first emission after it was created.
+ * dispatch() copies all new records out of the ring and emits them on
+ * target(); wait() sleeps on a futex until there is something to
+ * dispatch.
+ *
+ * A subscriber must only be used by one thread at a time.
+ */
+template <typename result_t, typename... arg_ts>
+class shm_subscriber<result_t(arg_ts...)>
+{
+public:
+    using call_t = result_t(arg_ts...);
+    using target_type = signal<call_t>;
+    using payload_type = typename shm_signal<call_t>::payload_type;
+
+public:
+    /**
+     * Map the shared memory object \a name of a shm_signal.
+     *
+     * @throws std::system_error if the object cannot be mapped.
+     * @throws std::runtime_error if the object does not belong to a
+     * shm_signal with the same argument layout.
+     */
+    explicit shm_subscriber(const std::string &name):
+        m_region(name),
+        m_header(layout::header(m_region.data())),
+        m_records(layout::records(m_region.data())),
+        m_capacity(0),
+        m_cursor(0),
+        m_lost(0)
+    {
+        if (m_region.size() < layout::records_offset ||
+                m_header->magic.load(std::memory_order_acquire) !=
+                    detail::shm_header::magic_value ||
+                m_header->payload_size != sizeof(payload_type) ||
+                m_region.size() < layout::size(m_header->capacity))
+        {
+            throw std::runtime_error("not a matching sig11::shm_signal: " + name);
+        }
+        m_capacity = m_header->capacity;
+        m_cursor = m_header->write_seq.load(std::memory_order_acquire);
+    }
+
+    shm_subscriber(const shm_subscriber &ref) = delete;
+    shm_subscriber &operator=(const shm_subscriber &ref) = delete;
+    shm_subscriber(shm_subscriber &&src) = delete;
+    shm_subscriber &operator=(shm_subscriber &&src) = delete;
+
+private:
+    using layout = detail::shm_layout<payload_type>;
+    using record = detail::shm_record<payload_type>;
+
+    detail::shm_region m_region;
+    detail::shm_header *const m_header;
+    record *const m_records;
+    std::size_t m_capacity;
+    std::uint64_t m_cursor;
+    std::uint64_t m_lost;
+    target_type m_target;
+
+public:
+    /**
+     * Emit all records which were published since the last call on
+     * target(), in order.
+     *
+     * @return The number of emissions which were delivered.
+     */
+    std::size_t dispatch()
+    {
+        const std::uint64_t end = m_header->write_seq.load(std::memory_order_acquire);
+        if (end - m_cursor > m_capacity) {
+            m_lost += end - m_capacity - m_cursor;
+            m_cursor = end - m_capacity;
+        }
+
+        std::size_t count = 0;
+        for (; m_cursor != end; ++m_cursor) {
+            const record &rec = m_records[m_cursor & (m_capacity - 1)];
+            const std::uint64_t expected = 2*m_cursor + 2;
+            if (rec.seq.load(std::memory_order_acquire) != expected) {
+                ++m_lost;
+                continue;
+            }
+            payload_type payload;
+            std::memcpy(&payload, &rec.payload, sizeof(payload));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (rec.seq.load(std::memory_order_relaxed) != expected) {
+                // overwritten while copying
+                ++m_lost;
+                continue;
+            }
+            detail::pod_apply(m_target, payload);
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * Sleep until a record is available for dispatch() or \a timeout
+     * expires.
+     *
+     * While a subscriber waits, each emission wakes it with a system call.
+     * If the process dies during the wait, the emitter keeps making that
+     * call on every emission (see detail::shm_header::sleepers).
+     *
+     * @return true if a record is available.
+     */
+    bool wait(std::chrono::nanoseconds timeout)
+    {
+        m_header->sleepers.fetch_add(1);
+        const std::uint32_t word = m_header->wake_seq.load();
+        bool ready = m_header->write_seq.load() != m_cursor;
+        if (!ready) {
+            detail::futex_wait(m_header->wake_seq, word, timeout);
+            ready = m_header->write_seq.load() != m_cursor;
+        }
+        m_header->sleepers.fetch_sub(1);
+        return ready;
+    }
+
+    /**
+     * The signal on which dispatch() delivers the emissions.
+     */
+    inline target_type &target()
+    {
+        return m_target;
+    }
+
+    /**
+     * The number of records which were overwritten before this subscriber
+     * could read them.
+     */
+    inline std::uint64_t lost() const
+    {
+        return m_lost;
+    }
+
+};
+
+}
+
+#endif
+
+#endif
@@ -24,12 +24,21 @@ in the AUTHORS file.
 #ifndef SIG11_H
 #define SIG11_H
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
-#include <map>
 #include <mutex>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "sig11/arena.hpp"
+#include "sig11/lock_policy.hpp"
+#include "sig11/tracer.hpp"
+
 
 namespace sig11 {
 
@@ -104,7 +113,9 @@ public:
         return m_id;
     }
 
-    template <typename T> friend class signal;
+    template <typename T, typename tracer_t, typename mutex_t> friend class signal;
+    template <std::size_t N, typename T, std::size_t S> friend class fixed_signal;
+    template <typename T> friend class wait_free_signal;
     friend class testutils;
 
     friend void swap(connection &a, connection &b);
@@ -136,12 +147,80 @@ static inline bool operator!=(const connection &conn, std::nullptr_t)
 }
 
 
-template <typename T>
+template <typename T, typename tracer_t = null_tracer, typename mutex_t = std::mutex>
 class signal;
 
 template <typename call_t>
 class connection_guard;
 
+
+namespace detail {
+
+/**
+ * True if std::function can be expected to store a \a callable_t without a
+ * heap allocation of its own.
+ *
+ * This mirrors the small-object rules of the common standard library
+ * implementations and errs on the side of false.
+ */
+template <typename callable_t>
+struct function_stores_inline: std::integral_constant<
+        bool,
+        sizeof(callable_t) <= 2*sizeof(void*) &&
+        alignof(callable_t) <= alignof(void*) &&
+        std::is_trivially_copyable<callable_t>::value>
+{
+
+};
+
+/**
+ * Intrusive, one-shot waiter for the next emission of a signal.
+ *
+ * The owner of the waiter provides the storage; the signal only links it
+ * into its waiter list. \a notify is called with the arguments of the next
+ * emission, after which the signal does not touch the waiter anymore.
+ *
+ * @see signal::add_waiter()
+ */
+template <typename... arg_ts>
+struct emit_waiter
+{
+    emit_waiter *next;
+    void (*notify)(emit_waiter *self, const arg_ts&... args);
+};
+
+/**
+ * Direct hop from a receiver slot into another signal.
+ *
+ * \a emit is a plain function pointer which emits the signal \a target
+ * points to, so that forwarding does not go through a std::function.
+ *
+ * @see signal::forward()
+ */
+template <typename... arg_ts>
+struct forward_hop
+{
+    void (*emit)(void *target, const arg_ts&... args);
+    void *target;
+};
+
+/**
+ * Trivially copyable forwarder to a callable which lives in an arena_box.
+ */
+template <typename callable_t>
+struct boxed_callable
+{
+    callable_t *callable;
+
+    template <typename... arg_ts>
+    inline void operator()(arg_ts&&... args) const
+    {
+        (*callable)(std::forward<arg_ts>(args)...);
+    }
+};
+
+}
+
 /**
  * The signal template allows to define signals.
  *
@@ -150,12 +229,24 @@ class connection_guard;
  *
  * All operations on a signal are thread-safe with respect to each other, with
  * one notable exception: it is not safe to emit the signal from multiple
- * threads without synchronization.
+ * threads without synchronization. A receiver may emit the signal it is
+ * connected to recursively.
  *
  * The argument types of a signal must be copyable.
+ *
+ * A signal can optionally be bound to a slot_arena, from which it then
+ * allocates the bookkeeping for its receivers.
+ *
+ * The \a tracer_t policy is notified around each emission and each receiver
+ * call; see null_tracer for the interface.
+ *
+ * The \a mutex_t policy protects the set of receivers. Besides std::mutex,
+ * null_mutex (for signals which are only used by a single thread), spin_mutex
+ * and shared_mutex can be used. If \a mutex_t supports lock_shared(),
+ * emissions and the visit_slot_state() functions take it in shared mode.
  */
-template <typename result_t, typename... arg_ts>
-class signal<result_t(arg_ts...)>
+template <typename result_t, typename... arg_ts, typename tracer_t, typename mutex_t>
+class signal<result_t(arg_ts...), tracer_t, mutex_t>
 {
 public:
     static_assert(std::is_void<result_t>::value,
@@ -164,13 +255,92 @@ public:
     using call_t = result_t(arg_ts...);
     using function_type = std::function<call_t>;
     using guard_t = connection_guard<call_t>;
+    using tracer_type = tracer_t;
+    using mutex_type = mutex_t;
+    using slot_state = typename tracer_t::slot_state;
+    using waiter_type = detail::emit_waiter<arg_ts...>;
 
 public:
     /**
      * Construct a new signal without any connected receivers.
      */
     signal():
-        m_token_id_ctr(0)
+        m_arena(nullptr),
+        m_token_id_ctr(0),
+        m_tombstones(0),
+        m_emitting(0),
+        m_compact_pending(false),
+        m_waiters(nullptr),
+        m_waiters_tail(nullptr)
+    {
+
+    }
+
+    /**
+     * Construct a new signal without any connected receivers, which draws the
+     * memory for connected receivers from \a arena.
+     *
+     * The \a arena must outlive the signal.
+     *
+     * @param arena The arena to allocate from.
+     */
+    explicit signal(slot_arena &arena):
+        m_arena(&arena),
+        m_token_id_ctr(0),
+        m_listeners(arena_allocator<listener*>(&arena)),
+        m_tombstones(0),
+        m_emitting(0),
+        m_compact_pending(false),
+        m_waiters(nullptr),
+        m_waiters_tail(nullptr),
+        m_listeners_tmp(arena_allocator<listener*>(&arena)),
+        m_nested_tmp(arena_allocator<detail::arena_box>(&arena))
+    {
+
+    }
+
+    /**
+     * Construct a new signal without any connected receivers and construct
+     * its tracer from \a tracer_args.
+     */
+    template <typename... tracer_arg_ts,
+              typename = typename std::enable_if<
+                  (sizeof...(tracer_arg_ts) > 0) &&
+                  std::is_constructible<tracer_t, tracer_arg_ts&&...>::value>::type>
+    explicit signal(tracer_arg_ts&&... tracer_args):
+        m_arena(nullptr),
+        m_tracer(std::forward<tracer_arg_ts>(tracer_args)...),
+        m_token_id_ctr(0),
+        m_tombstones(0),
+        m_emitting(0),
+        m_compact_pending(false),
+        m_waiters(nullptr),
+        m_waiters_tail(nullptr)
+    {
+
+    }
+
+    /**
+     * Construct a new signal without any connected receivers, which draws the
+     * memory for connected receivers from \a arena, and construct its tracer
+     * from \a tracer_args.
+     */
+    template <typename... tracer_arg_ts,
+              typename = typename std::enable_if<
+                  (sizeof...(tracer_arg_ts) > 0) &&
+                  std::is_constructible<tracer_t, tracer_arg_ts&&...>::value>::type>
+    signal(slot_arena &arena, tracer_arg_ts&&... tracer_args):
+        m_arena(&arena),
+        m_tracer(std::forward<tracer_arg_ts>(tracer_args)...),
+        m_token_id_ctr(0),
+        m_listeners(arena_allocator<listener*>(&arena)),
+        m_tombstones(0),
+        m_emitting(0),
+        m_compact_pending(false),
+        m_waiters(nullptr),
+        m_waiters_tail(nullptr),
+        m_listeners_tmp(arena_allocator<listener*>(&arena)),
+        m_nested_tmp(arena_allocator<detail::arena_box>(&arena))
     {
 
     }
@@ -180,12 +350,309 @@ public:
     signal(signal &&src) = delete;
     signal &operator=(signal &&src) = delete;
 
+    ~signal()
+    {
+        for (listener *node: m_listeners) {
+            destroy_listener(node);
+        }
+    }
+
+public:
+    /**
+     * Minimum number of tombstones before the receiver list is compacted.
+     */
+    static constexpr std::size_t compact_min_tombstones = 16;
+
 private:
-    mutable std::mutex m_listeners_mutex;
+    using forward_type = detail::forward_hop<arg_ts...>;
+
+    struct listener: public slot_state
+    {
+        listener(token_id token, bool once, function_type &&fn,
+                 detail::arena_box &&storage, const forward_type &hop):
+            token(token),
+            once(once),
+            disconnected(false),
+            hop(hop),
+            storage(std::move(storage)),
+            fn(std::move(fn))
+        {
+
+        }
+
+        /**
+         * Destroy the receiver, leaving only the tombstone.
+         */
+        void release()
+        {
+            fn = nullptr;
+            storage.reset();
+        }
+
+        token_id token;
+
+        /**
+         * Set for receivers connected with connect_once().
+         */
+        const bool once;
+
+        /**
+         * Tombstone flag, set by disconnect() or by the emission which
+         * claims a one-shot receiver. Emissions skip tombstones; they are
+         * removed from the receiver list by compact().
+         */
+        std::atomic<bool> disconnected;
+
+        /**
+         * Set for receivers connected with forward(); fn is empty then.
+         */
+        const forward_type hop;
+
+        /**
+         * Storage for the receiver if it was too large for the inline
+         * storage of the std::function; must outlive fn.
+         */
+        detail::arena_box storage;
+        function_type fn;
+    };
+
+    using listener_allocator = arena_allocator<listener>;
+    using listener_list = std::vector<listener*, arena_allocator<listener*> >;
+    using dispatch_buffer = std::vector<listener*, arena_allocator<listener*> >;
+
+    /**
+     * Marks an emission as in progress for its lifetime.
+     */
+    class emit_guard
+    {
+    public:
+        explicit emit_guard(signal &owner):
+            m_owner(owner)
+        {
+
+        }
+
+        ~emit_guard()
+        {
+            if (m_owner.m_emitting.fetch_sub(1) == 1 &&
+                    m_owner.m_compact_pending.load())
+            {
+                std::lock_guard<mutex_t> lock(m_owner.m_listeners_mutex);
+                if (m_owner.m_emitting.load() == 0) {
+                    m_owner.compact();
+                }
+            }
+        }
+
+    private:
+        signal &m_owner;
+    };
+
+    slot_arena *const m_arena;
+    tracer_t m_tracer;
+
+    mutable mutex_t m_listeners_mutex;
     token_id m_token_id_ctr;
-    std::map<token_id, function_type> m_listeners;
 
-    std::vector<function_type*> m_listeners_tmp;
+    /**
+     * Receivers in connection order (and thus ordered by token), including
+     * tombstones.
+     */
+    listener_list m_listeners;
+    std::atomic<std::size_t> m_tombstones;
+
+    /**
+     * Number of emissions in progress; while non-zero, tombstones keep their
+     * receiver and must not be compacted away, as the emissions may still
+     * hold pointers to them.
+     *
+     * It is incremented with the mutex held (possibly in shared mode) and
+     * decremented without it, so that an emission only locks once. The last
+     * emission to finish takes the mutex only if m_compact_pending is set.
+     */
+    std::atomic<std::size_t> m_emitting;
+    std::atomic<bool> m_compact_pending;
+
+    /**
+     * One-shot waiters for the next emission, in registration order.
+     */
+    waiter_type *m_waiters;
+    waiter_type *m_waiters_tail;
+
+    /**
+     * Dispatch buffer of the outermost emission.
+     */
+    dispatch_buffer m_listeners_tmp;
+
+    /**
+     * Dispatch buffers of recursive emissions, indexed by nesting depth
+     * minus one. Each buffer is boxed, so that the buffers of the outer
+     * emissions stay in place while the list grows; buffers are kept for
+     * reuse. The list starts out empty and thus does not allocate unless
+     * the signal is emitted recursively.
+     */
+    std::vector<detail::arena_box, arena_allocator<detail::arena_box> > m_nested_tmp;
+
+    dispatch_buffer &dispatch_buffer_for(std::size_t depth)
+    {
+        if (depth == 0) {
+            return m_listeners_tmp;
+        }
+        while (m_nested_tmp.size() < depth) {
+            m_nested_tmp.push_back(detail::arena_box::make<dispatch_buffer>(
+                                       m_arena, arena_allocator<listener*>(m_arena)));
+        }
+        return *static_cast<dispatch_buffer*>(m_nested_tmp[depth-1].get());
+    }
+
+    listener *make_listener(token_id token, bool once, function_type &&fn,
+                            detail::arena_box &&storage, const forward_type &hop)
+    {
+        listener_allocator alloc(m_arena);
+        listener *node = alloc.allocate(1);
+        try {
+            new (node) listener(token, once, std::move(fn), std::move(storage), hop);
+        } catch (...) {
+            alloc.deallocate(node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    void destroy_listener(listener *node)
+    {
+        node->~listener();
+        listener_allocator(m_arena).deallocate(node, 1);
+    }
+
+    /**
+     * Find the live listener with the given \a token, or nullptr.
+     */
+    listener *find_listener(token_id token) const
+    {
+        auto iter = std::lower_bound(
+                    m_listeners.begin(), m_listeners.end(), token,
+                    [](const listener *node, token_id token){ return node->token < token; });
+        if (iter == m_listeners.end() || (*iter)->token != token ||
+                (*iter)->disconnected.load(std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+        return *iter;
+    }
+
+    /**
+     * Remove all tombstones from the receiver list in a single pass.
+     *
+     * Must only be called with the mutex held and no emission in progress.
+     */
+    void compact()
+    {
+        auto out = m_listeners.begin();
+        for (listener *node: m_listeners) {
+            if (node->disconnected.load(std::memory_order_relaxed)) {
+                destroy_listener(node);
+            } else {
+                *out++ = node;
+            }
+        }
+        m_listeners.erase(out, m_listeners.end());
+        m_tombstones.store(0, std::memory_order_relaxed);
+        m_compact_pending.store(false, std::memory_order_relaxed);
+    }
+
+    connection emplace_listener(bool once, function_type &&fn,
+                                detail::arena_box &&storage,
+                                const forward_type &hop = forward_type{nullptr, nullptr})
+    {
+        std::lock_guard<mutex_t> lock(m_listeners_mutex);
+        // pick up tombstones of claimed one-shot receivers
+        if (m_emitting.load() == 0 &&
+                compaction_due(m_tombstones.load(), m_listeners.size()))
+        {
+            compact();
+        }
+        const token_id token = m_token_id_ctr;
+        listener *node = make_listener(token, once, std::move(fn), std::move(storage), hop);
+        try {
+            m_listeners.push_back(node);
+        } catch (...) {
+            destroy_listener(node);
+            throw;
+        }
+        ++m_token_id_ctr;
+        m_tracer.on_connect(token, *node);
+        return connection(token);
+    }
+
+    template <typename callable_t>
+    connection connect_callable(bool once, callable_t &&receiver, std::false_type)
+    {
+        return emplace_listener(once,
+                                function_type(std::forward<callable_t>(receiver)),
+                                detail::arena_box());
+    }
+
+    template <typename callable_t>
+    connection connect_callable(bool once, callable_t &&receiver, std::true_type)
+    {
+        using stored_t = typename std::decay<callable_t>::type;
+        if (!m_arena) {
+            return connect_callable(once, std::forward<callable_t>(receiver),
+                                    std::false_type());
+        }
+        detail::arena_box storage(detail::arena_box::make<stored_t>(
+                                      m_arena, std::forward<callable_t>(receiver)));
+        function_type fn(detail::boxed_callable<stored_t>{
+                             static_cast<stored_t*>(storage.get())});
+        return emplace_listener(once, std::move(fn), std::move(storage));
+    }
+
+    template <typename callable_t>
+    connection connect_any(bool once, callable_t &&receiver)
+    {
+        using stored_t = typename std::decay<callable_t>::type;
+        return connect_callable(
+                    once,
+                    std::forward<callable_t>(receiver),
+                    std::integral_constant<
+                        bool,
+                        !std::is_same<stored_t, function_type>::value &&
+                        !detail::function_stores_inline<stored_t>::value>());
+    }
+
+    /**
+     * Return whether \a tombstones are enough to compact a receiver list of
+     * \a size entries.
+     */
+    static bool compaction_due(std::size_t tombstones, std::size_t size)
+    {
+        return tombstones >= std::max(compact_min_tombstones, size / 2);
+    }
+
+    /**
+     * Claim the one-shot receiver \a entry for the current emission.
+     *
+     * Claimed receivers are tombstones like disconnected ones. They are only
+     * compacted away once enough of them have piled up, so that firing a
+     * one-shot does not make the emission take the mutex; \a live is the
+     * number of receivers in the snapshot of the emission, standing in for
+     * the size of the receiver list, which must not be read here.
+     *
+     * @return true if this emission gets to call it.
+     */
+    bool claim_once(listener *entry, std::size_t live)
+    {
+        if (entry->disconnected.exchange(true, std::memory_order_acq_rel)) {
+            return false;
+        }
+        m_tracer.on_disconnect(entry->token, *entry);
+        if (compaction_due(m_tombstones.fetch_add(1) + 1, live)) {
+            // the emission in progress compacts once it has finished
+            m_compact_pending.store(true);
+        }
+        return true;
+    }
 
 public:
     /**
@@ -194,21 +661,86 @@ public:
      * The arguments are restricted to be const references as they are copied
      * for each receiver.
      *
+     * Receivers which are disconnected while the emission is in progress are
+     * not called anymore by that emission.
+     *
+     * A receiver may emit the signal again. Each nesting level uses its own
+     * dispatch buffer; the buffers are kept, so that only the first emission
+     * at a new depth allocates.
+     *
      * No two threads must call this function without synchronization.
+     *
+     * @see emit()
+     */
+    inline void operator()(const arg_ts&... args)
+    {
+        emit(args...);
+    }
+
+    /**
+     * Emit the signal with the given arguments, like operator()().
+     *
+     * @return true if at least one receiver was called.
      */
-    void operator()(const arg_ts&... args)
+    bool emit(const arg_ts&... args)
     {
-        m_listeners_tmp.clear();
+        // only the emitting thread modifies m_emitting, so this is the
+        // nesting depth of this emission
+        dispatch_buffer &targets = dispatch_buffer_for(
+                    m_emitting.load(std::memory_order_relaxed));
+        targets.clear();
+        waiter_type *waiters = nullptr;
         {
-            std::lock_guard<std::mutex> lock(m_listeners_mutex);
-            for (auto &entry: m_listeners) {
-                m_listeners_tmp.push_back(&entry.second);
+            detail::shared_lock_guard<mutex_t> lock(m_listeners_mutex);
+            for (listener *node: m_listeners) {
+                if (!node->disconnected.load(std::memory_order_relaxed)) {
+                    targets.push_back(node);
+                }
+            }
+            if (m_waiters) {
+                // emissions do not run concurrently, so even in shared mode
+                // nobody else modifies the waiter list
+                waiters = m_waiters;
+                m_waiters = nullptr;
+                m_waiters_tail = nullptr;
             }
+            m_emitting.fetch_add(1);
         }
-        for (function_type *listener: m_listeners_tmp)
+        emit_guard guard(*this);
+
+        m_tracer.on_emit_begin();
+        while (waiters) {
+            // the waiter may be gone once it has been notified
+            waiter_type *next = waiters->next;
+            waiters->notify(waiters, args...);
+            waiters = next;
+        }
+        bool dispatched = false;
+        for (listener *entry: targets)
         {
-            (*listener)(args...);
+            if (entry->once) {
+                if (!claim_once(entry, targets.size())) {
+                    continue;
+                }
+            } else if (entry->disconnected.load(std::memory_order_acquire)) {
+                continue;
+            }
+            dispatched = true;
+            m_tracer.on_slot_begin(entry->token, *entry);
+            if (entry->hop.emit) {
+                entry->hop.emit(entry->hop.target, args...);
+            } else {
+                entry->fn(args...);
+            }
+            m_tracer.on_slot_end(entry->token, *entry);
+            if (entry->once) {
+                // only the claiming emission ever touches the receiver, so
+                // it can go right away; the tombstone waits for compaction
+                entry->release();
+            }
         }
+        m_tracer.on_emit_end();
+        return dispatched;
     }
 
     /**
@@ -223,10 +755,81 @@ public:
      */
     connection connect(function_type &&receiver)
     {
-        std::lock_guard<std::mutex> lock(m_listeners_mutex);
-        token_id token = m_token_id_ctr++;
-        m_listeners.emplace(token, std::move(receiver));
-        return connection(token);
+        return emplace_listener(false, std::move(receiver), detail::arena_box());
+    }
+
+    /**
+     * Connect an arbitrary callable \a receiver to the signal.
+     *
+     * If the signal uses a slot_arena and the receiver is too large to be
+     * stored inline in a std::function, the receiver is stored in the arena.
+     *
+     * This function is thread-safe.
+     *
+     * @param receiver The callable to connect.
+     * @return A connection for the newly connected receiver.
+     */
+    template <typename callable_t,
+              typename = typename std::enable_if<
+                  !std::is_same<typename std::decay<callable_t>::type,
+                                function_type>::value>::type>
+    connection connect(callable_t &&receiver)
+    {
+        return connect_any(false, std::forward<callable_t>(receiver));
+    }
+
+    /**
+     * Connect a \a receiver which is called at most once.
+     *
+     * The first emission which reaches the receiver claims it atomically
+     * and retires it before calling it, without taking the mutex of the
+     * signal. Even with concurrent emissions, the receiver is called exactly
+     * once, unless it is disconnected before. The receiver is destroyed
+     * right after the call; its bookkeeping is removed in batches like that
+     * of disconnected receivers (see disconnect()), by a later connect(),
+     * disconnect() or emission.
+     *
+     * This function is thread-safe.
+     *
+     * @param receiver The callable to connect.
+     * @return A connection which can be used to disconnect the receiver
+     * before it has been called.
+     */
+    template <typename callable_t>
+    connection connect_once(callable_t &&receiver)
+    {
+        return connect_any(true, std::forward<callable_t>(receiver));
+    }
+
+    /**
+     * Forward every emission of this signal to the signal \a target.
+     *
+     * The forwarding receiver calls \a target through a plain function
+     * pointer instead of wrapping it in a std::function. The set of
+     * receivers of \a target is still resolved when it is emitted, since it
+     * can change independently of this signal; forwarding chains are thus
+     * not flattened.
+     *
+     * \a target must outlive the connection. The same restrictions as for
+     * emitting \a target directly apply, in particular that it must not be
+     * emitted from multiple threads without synchronization.
+     *
+     * This function is thread-safe.
+     *
+     * @param target Any signal which can be called with the arguments of
+     * this signal.
+     * @return A connection for the forwarding receiver.
+     */
+    template <typename target_signal_t>
+    connection forward(target_signal_t &target)
+    {
+        const forward_type hop{
+            [](void *target, const arg_ts&... args){
+                (*static_cast<target_signal_t*>(target))(args...);
+            },
+            &target
+        };
+        return emplace_listener(false, function_type(), detail::arena_box(), hop);
     }
 
     /**
@@ -235,7 +838,11 @@ public:
      * If the \a conn is not valid or refers to a non-existent connection, this
      * is a no-op.
      *
-     * This function is thread-safe.
+     * This function is thread-safe. The receiver is only marked as
+     * disconnected (a tombstone) and destroyed right away; the bookkeeping
+     * is removed in batches, once at least #compact_min_tombstones and half
+     * of the receivers are tombstones. If the signal is being emitted, the
+     * receiver is destroyed once the last emission has finished.
      *
      * @param conn The connection to disconnect.
      */
@@ -245,17 +852,167 @@ public:
             return;
         }
 
-        std::lock_guard<std::mutex> lock(m_listeners_mutex);
-        auto iter = m_listeners.find(conn.id());
-        if (iter == m_listeners.end()) {
+        std::lock_guard<mutex_t> lock(m_listeners_mutex);
+        listener *node = find_listener(conn.id());
+        // a concurrent emission may claim a one-shot receiver at any time
+        if (!node || node->disconnected.exchange(true, std::memory_order_acq_rel)) {
             return;
         }
-        m_listeners.erase(iter);
+        m_tracer.on_disconnect(node->token, *node);
+        m_tombstones.fetch_add(1);
         conn = nullptr;
+
+        if (m_emitting.load() > 0) {
+            m_compact_pending.store(true);
+            /* the last emission may have finished before it could see
+             * m_compact_pending */
+            if (m_emitting.load() == 0) {
+                compact();
+            }
+            return;
+        }
+
+        node->release();
+        if (compaction_due(m_tombstones.load(), m_listeners.size())) {
+            compact();
+        }
+    }
+
+    /**
+     * Register \a waiter to be notified by the next emission of the signal.
+     *
+     * Waiters are notified in registration order, before the connected
+     * receivers are called, and are unregistered by that. The signal does
+     * not allocate for waiters; \a waiter must stay alive until it has been
+     * notified or removed with remove_waiter().
+     *
+     * This function is thread-safe.
+     *
+     * @see sig11::next()
+     */
+    void add_waiter(waiter_type &waiter)
+    {
+        std::lock_guard<mutex_t> lock(m_listeners_mutex);
+        waiter.next = nullptr;
+        if (m_waiters_tail) {
+            m_waiters_tail->next = &waiter;
+        } else {
+            m_waiters = &waiter;
+        }
+        m_waiters_tail = &waiter;
+    }
+
+    /**
+     * Unregister a \a waiter which has not been notified yet.
+     *
+     * This function is thread-safe. It must not race with an emission
+     * which may notify the waiter.
+     *
+     * @return true if the waiter was registered.
+     */
+    bool remove_waiter(waiter_type &waiter)
+    {
+        std::lock_guard<mutex_t> lock(m_listeners_mutex);
+        waiter_type *prev = nullptr;
+        for (waiter_type *curr = m_waiters; curr; prev = curr, curr = curr->next) {
+            if (curr != &waiter) {
+                continue;
+            }
+            if (prev) {
+                prev->next = curr->next;
+            } else {
+                m_waiters = curr->next;
+            }
+            if (m_waiters_tail == curr) {
+                m_waiters_tail = prev;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Call \a visitor with the tracer slot_state of the connection \a conn.
+     *
+     * The mutex of the signal is held (in shared mode, if supported) while
+     * \a visitor runs, so it must not connect to or disconnect from the
+     * signal. The signal may still be emitted concurrently, so the tracer
+     * must synchronize access to its slot_state accordingly.
+     *
+     * @param conn The connection whose state to visit.
+     * @param visitor Callable taking a slot_state reference.
+     * @return true if the connection was found and \a visitor was called.
+     */
+    template <typename visitor_t>
+    bool visit_slot_state(const connection &conn, visitor_t &&visitor)
+    {
+        if (!conn) {
+            return false;
+        }
+
+        detail::shared_lock_guard<mutex_t> lock(m_listeners_mutex);
+        listener *node = find_listener(conn.id());
+        if (!node) {
+            return false;
+        }
+        visitor(static_cast<slot_state&>(*node));
+        return true;
+    }
+
+    /**
+     * Call \a visitor with the token_id and the tracer slot_state of each
+     * connected receiver, in connection order.
+     *
+     * The same restrictions as for visit_slot_state() apply.
+     *
+     * @param visitor Callable taking a token_id and a slot_state reference.
+     */
+    template <typename visitor_t>
+    void visit_slot_states(visitor_t &&visitor)
+    {
+        detail::shared_lock_guard<mutex_t> lock(m_listeners_mutex);
+        for (listener *node: m_listeners) {
+            if (node->disconnected.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            visitor(node->token, static_cast<slot_state&>(*node));
+        }
+    }
+
+    /**
+     * Return true if no receiver is connected.
+     *
+     * This function is thread-safe; with concurrent connects, disconnects
+     * or emissions (which retire one-shot receivers), the result may be
+     * outdated by the time it is returned.
+     */
+    bool empty() const
+    {
+        detail::shared_lock_guard<mutex_t> lock(m_listeners_mutex);
+        return m_listeners.size() == m_tombstones.load();
+    }
+
+    /**
+     * Access the tracer of the signal.
+     */
+    inline tracer_t &tracer()
+    {
+        return m_tracer;
+    }
+
+    /**
+     * Access the tracer of the signal.
+     */
+    inline const tracer_t &tracer() const
+    {
+        return m_tracer;
     }
 
 };
 
+template <typename result_t, typename... arg_ts, typename tracer_t, typename mutex_t>
+constexpr std::size_t signal<result_t(arg_ts...), tracer_t, mutex_t>::compact_min_tombstones;
+
 
 /**
  * Use connection_guard to implement scoped disconnection of connections.
@@ -263,6 +1020,10 @@ public:
  * A connection_guard takes a connection and a signal. When it goes out of
  * scope or is assigned another value (including nullptr), the connection is
  * disconnected from the signal.
+ *
+ * Any signal type with the call signature \a call_t which hands out
+ * connection objects (signal, fixed_signal, ...) can be used with a
+ * connection_guard.
  */
 template <typename call_t>
 class connection_guard
@@ -276,7 +1037,8 @@ public:
      */
     connection_guard(std::nullptr_t = nullptr):
         m_connection(nullptr),
-        m_signal(nullptr)
+        m_signal(nullptr),
+        m_disconnect(nullptr)
     {
 
     }
@@ -290,11 +1052,14 @@ public:
      * @param conn The connection to manage.
      * @param signal The signal to which the connection belongs.
      */
-    connection_guard(connection &&conn, signal_t &signal):
+    template <typename any_signal_t>
+    connection_guard(connection &&conn, any_signal_t &signal):
         m_connection(std::move(conn)),
-        m_signal(&signal)
+        m_signal(&signal),
+        m_disconnect(&disconnect_from<any_signal_t>)
     {
-
+        static_assert(std::is_same<typename any_signal_t::call_t, call_t>::value,
+                      "signal signature does not match the guard");
     }
 
     connection_guard(const connection_guard &ref) = delete;
@@ -310,7 +1075,8 @@ public:
      */
     connection_guard(connection_guard &&src):
         m_connection(std::move(src.m_connection)),
-        m_signal(src.m_signal)
+        m_signal(src.m_signal),
+        m_disconnect(src.m_disconnect)
     {
         src.m_signal = nullptr;
     }
@@ -331,6 +1097,7 @@ public:
         disconnect();
         m_connection = std::move(src.m_connection);
         m_signal = src.m_signal;
+        m_disconnect = src.m_disconnect;
         src.m_signal = nullptr;
         return *this;
     }
@@ -357,7 +1124,14 @@ public:
 
 private:
     connection m_connection;
-    signal_t *m_signal;
+    void *m_signal;
+    void (*m_disconnect)(void *signal, connection &conn);
+
+    template <typename any_signal_t>
+    static void disconnect_from(void *signal, connection &conn)
+    {
+        static_cast<any_signal_t*>(signal)->disconnect(conn);
+    }
 
 public:
     /**
@@ -376,7 +1150,7 @@ public:
     void disconnect()
     {
         if (m_signal) {
-            m_signal->disconnect(m_connection);
+            m_disconnect(m_signal, m_connection);
             release();
         }
     }
@@ -432,6 +1206,7 @@ static inline void swap(connection_guard<call_t> &a, connection_guard<call_t> &b
 {
     swap(a.m_connection, b.m_connection);
     std::swap(a.m_signal, b.m_signal);
+    std::swap(a.m_disconnect, b.m_disconnect);
 }
 
 
@@ -440,13 +1215,27 @@ static inline void swap(connection_guard<call_t> &a, connection_guard<call_t> &b
  *
  * It returns a connection_guard for the new connection.
  */
-template <typename call_t, typename callable_t>
-static inline connection_guard<call_t> connect [[gnu::warn_unused_result]] (signal<call_t> &signal,
+template <typename call_t, typename tracer_t, typename mutex_t, typename callable_t>
+static inline connection_guard<call_t> connect [[gnu::warn_unused_result]] (signal<call_t, tracer_t, mutex_t> &signal,
                                                                             callable_t &&receiver)
 {
     return connection_guard<call_t>(signal.connect(std::forward<callable_t>(receiver)), signal);
 }
 
+/**
+ * Forward every emission of the signal \a source to the signal \a target.
+ *
+ * It returns a connection_guard for the forwarding connection.
+ *
+ * @see signal::forward()
+ */
+template <typename call_t, typename tracer_t, typename mutex_t, typename target_signal_t>
+static inline connection_guard<call_t> forward [[gnu::warn_unused_result]] (signal<call_t, tracer_t, mutex_t> &source,
+                                                                            target_signal_t &target)
+{
+    return connection_guard<call_t>(source.forward(target), source);
+}
+
 
 }
 
@@ -0,0 +1,210 @@
+/**********************************************************************
+File name: static_signal.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_STATIC_SIGNAL_H
+#define SIG11_STATIC_SIGNAL_H
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+namespace sig11 {
+
+/**
+ * Stateless function object which calls the function \a fn.
+ *
+ * This allows to pass a plain function as a receiver type to static_signal,
+ * so that the call is resolved at compile time instead of through a function
+ * pointer stored in the signal:
+ *
+ *     sig11::static_signal<void(int), sig11::static_fn<decltype(&f), &f>>
+ */
+template <typename fn_t, fn_t fn>
+struct static_fn
+{
+    template <typename... arg_ts>
+    inline void operator()(arg_ts&&... args) const
+    {
+        fn(std::forward<arg_ts>(args)...);
+    }
+};
+
+
+template <typename call_t, typename... receiver_ts>
+class static_signal;
+
+namespace detail {
+
+/**
+ * True if the argument list \a init_ts consists of a single \a self_t,
+ * i.e. if a constructor call with it is meant to be a copy or move.
+ */
+template <typename self_t, typename... init_ts>
+struct is_self_argument: std::false_type
+{
+};
+
+template <typename self_t, typename init_t>
+struct is_self_argument<self_t, init_t>:
+        std::is_same<self_t, typename std::decay<init_t>::type>
+{
+};
+
+}
+
+/**
+ * A static_signal is a signal whose set of receivers is fixed at compile time.
+ *
+ * The receivers are part of the type and stored by value in the signal.
+ * Emission calls each receiver directly, in order, so that the compiler can
+ * inline the whole fan-out; there is no locking, no container and no type
+ * erasure involved.
+ *
+ * static_signal provides the same call_t typedef and emission operator as
+ * signal, so that code which only emits a signal can switch between the two
+ * with a typedef change. Since there is nothing to connect to or disconnect
+ * from at runtime, a static_signal is safe to emit from multiple threads as
+ * long as its receivers are.
+ *
+ * Receivers can either be listed as template arguments (and are then default
+ * constructed), passed to the constructor, or added with the constexpr
+ * builder function connect():
+ *
+ *     constexpr auto signal = sig11::static_signal<void(int)>()
+ *         .connect(receiver_a())
+ *         .connect(receiver_b());
+ *
+ * @see make_static_signal
+ */
+template <typename result_t, typename... arg_ts, typename... receiver_ts>
+class static_signal<result_t(arg_ts...), receiver_ts...>
+{
+public:
+    static_assert(std::is_void<result_t>::value,
+                  "signals with non-void return values are not supported.");
+
+    using call_t = result_t(arg_ts...);
+
+public:
+    /**
+     * Construct the signal with default constructed receivers.
+     */
+    constexpr static_signal() = default;
+
+    /**
+     * Construct the signal from the given \a receivers.
+     */
+    template <typename... init_ts,
+              typename = typename std::enable_if<
+                  sizeof...(init_ts) == sizeof...(receiver_ts) &&
+                  sizeof...(init_ts) != 0 &&
+                  !detail::is_self_argument<static_signal, init_ts...>::value>::type>
+    constexpr explicit static_signal(init_ts&&... receivers):
+        m_receivers(std::forward<init_ts>(receivers)...)
+    {
+
+    }
+
+private:
+    std::tuple<receiver_ts...> m_receivers;
+
+    template <std::size_t... indices>
+    inline void emit(std::index_sequence<indices...>, const arg_ts&... args) const
+    {
+        using expander = int[];
+        (void)expander{0, (std::get<indices>(m_receivers)(args...), 0)...};
+    }
+
+    template <std::size_t... indices, typename receiver_t>
+    constexpr static_signal<call_t, receiver_ts..., typename std::decay<receiver_t>::type>
+    append(std::index_sequence<indices...>, receiver_t &&receiver) const
+    {
+        return static_signal<call_t, receiver_ts..., typename std::decay<receiver_t>::type>(
+                    std::get<indices>(m_receivers)...,
+                    std::forward<receiver_t>(receiver));
+    }
+
+public:
+    /**
+     * Emit the signal with the given arguments.
+     *
+     * The receivers are called in the order in which they were listed.
+     * They are called as const objects, so that a constexpr signal can be
+     * emitted.
+     */
+    inline void operator()(const arg_ts&... args) const
+    {
+        emit(std::index_sequence_for<receiver_ts...>(), args...);
+    }
+
+    /**
+     * Return a new static_signal which calls all receivers of this signal and
+     * \a receiver afterwards.
+     *
+     * @param receiver The receiver to append.
+     */
+    template <typename receiver_t>
+    constexpr static_signal<call_t, receiver_ts..., typename std::decay<receiver_t>::type>
+    connect(receiver_t &&receiver) const
+    {
+        return append(std::index_sequence_for<receiver_ts...>(),
+                      std::forward<receiver_t>(receiver));
+    }
+
+    /**
+     * Access the receiver at \a index.
+     */
+    template <std::size_t index>
+    constexpr const typename std::tuple_element<index, std::tuple<receiver_ts...> >::type &
+    receiver() const
+    {
+        return std::get<index>(m_receivers);
+    }
+
+    /**
+     * The number of receivers of the signal.
+     */
+    static constexpr std::size_t size()
+    {
+        return sizeof...(receiver_ts);
+    }
+
+};
+
+
+/**
+ * Create a static_signal for the \a call_t signature from a set of
+ * \a receivers.
+ */
+template <typename call_t, typename... receiver_ts>
+constexpr static_signal<call_t, typename std::decay<receiver_ts>::type...>
+make_static_signal(receiver_ts&&... receivers)
+{
+    return static_signal<call_t, typename std::decay<receiver_ts>::type...>(
+                std::forward<receiver_ts>(receivers)...);
+}
+
+}
+
+#endif
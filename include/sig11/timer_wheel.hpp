@@ -0,0 +1,292 @@
+/**********************************************************************
+File name: timer_wheel.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_TIMER_WHEEL_H
+#define SIG11_TIMER_WHEEL_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "sig11/arena.hpp"
+
+
+namespace sig11 {
+
+/**
+ * Handle for a timer scheduled on a timer_wheel.
+ *
+ * A handle stays valid after its timer has fired or has been cancelled, but
+ * does not refer to any timer anymore then.
+ */
+class timer_handle
+{
+public:
+    constexpr timer_handle():
+        m_index(0),
+        m_generation(0)
+    {
+
+    }
+
+    constexpr timer_handle(std::uint32_t index, std::uint32_t generation):
+        m_index(index),
+        m_generation(generation)
+    {
+
+    }
+
+private:
+    std::uint32_t m_index;
+
+    /**
+     * Generation of the timer slot; zero for the empty handle.
+     */
+    std::uint32_t m_generation;
+
+public:
+    inline std::uint32_t index() const
+    {
+        return m_index;
+    }
+
+    inline std::uint32_t generation() const
+    {
+        return m_generation;
+    }
+
+    /**
+     * Return false for default constructed handles.
+     */
+    inline explicit operator bool() const
+    {
+        return m_generation != 0;
+    }
+
+    inline bool operator==(const timer_handle &other) const
+    {
+        return m_index == other.m_index && m_generation == other.m_generation;
+    }
+
+    inline bool operator!=(const timer_handle &other) const
+    {
+        return !(*this == other);
+    }
+
+};
+
+
+/**
+ * A hierarchical timer wheel which can serve many timers from a single
+ * thread.
+ *
+ * Time is divided into ticks of #resolution. Timers are kept in #levels
+ * wheels of #slots_per_level slots each, where a slot of level L spans
+ * 64^L ticks; timers further in the future than the top level wheel can
+ * cover wait in an overflow list. Scheduling and cancelling are O(1).
+ * Advancing the wheel skips the ticks on which no slot is due, so a long
+ * gap costs O(#levels * #slots_per_level) per due slot plus the number of
+ * timers which expire or move to a finer level.
+ *
+ * The wheel has no thread of its own: advance() must be called regularly
+ * (for example from an event loop) with the current time, and runs the
+ * callbacks of the expired timers. A timer fires on the first advance()
+ * whose time is at or past its deadline, rounded up to the next tick.
+ *
+ * Timers are stored in a slot map and addressed by a timer_handle, so that
+ * no allocation is needed per timer once the map has grown to the number
+ * of concurrently scheduled timers. Callbacks are plain function pointers
+ * with a context pointer. A timer may own its context: its discard
+ * function is called instead of the callback if the timer is cancelled or
+ * the wheel is destroyed first. Such contexts can be allocated from
+ * payload_arena().
+ *
+ * schedule() and cancel() are thread-safe; advance() must not be called
+ * from multiple threads at the same time. Callbacks run without the
+ * internal lock held and may schedule and cancel timers.
+ */
+class timer_wheel
+{
+public:
+    using clock = std::chrono::steady_clock;
+    using time_point = clock::time_point;
+    using duration = clock::duration;
+    using callback_type = void (*)(void *context);
+    using discard_type = void (*)(void *context);
+
+    static constexpr unsigned level_bits = 6;
+    static constexpr std::size_t slots_per_level = std::size_t(1) << level_bits;
+    static constexpr std::size_t levels = 4;
+
+public:
+    /**
+     * Construct a wheel with ticks of \a resolution, whose time starts at
+     * \a start.
+     */
+    explicit timer_wheel(duration resolution = std::chrono::milliseconds(1),
+                         time_point start = clock::now());
+    ~timer_wheel();
+
+    timer_wheel(const timer_wheel &ref) = delete;
+    timer_wheel &operator=(const timer_wheel &ref) = delete;
+    timer_wheel(timer_wheel &&src) = delete;
+    timer_wheel &operator=(timer_wheel &&src) = delete;
+
+private:
+    static constexpr std::uint32_t npos = ~std::uint32_t(0);
+    static constexpr std::size_t overflow_bucket = levels * slots_per_level;
+    static constexpr std::size_t expired_bucket = overflow_bucket + 1;
+    static constexpr std::size_t bucket_count = expired_bucket + 1;
+
+    struct entry
+    {
+        std::uint32_t generation;
+        std::uint32_t prev;
+        std::uint32_t next;
+        std::uint32_t bucket;
+        std::uint64_t deadline;
+        callback_type callback;
+        discard_type discard;
+        void *context;
+    };
+
+    const duration m_resolution;
+    const time_point m_start;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_callback_done;
+
+    std::vector<entry> m_entries;
+    std::uint32_t m_free;
+    std::size_t m_active;
+    std::array<std::uint32_t, bucket_count> m_buckets;
+
+    /**
+     * The current tick; all timers with an earlier deadline have fired.
+     */
+    std::uint64_t m_current;
+
+    /**
+     * The timer whose callback is running, if any.
+     */
+    timer_handle m_running;
+    std::thread::id m_running_thread;
+
+    slot_arena m_payload_arena;
+
+    std::uint64_t tick_for(time_point when) const;
+    std::size_t bucket_for(std::uint64_t deadline) const;
+    void link(std::uint32_t index, std::size_t bucket);
+    void unlink(std::uint32_t index);
+    void release(std::uint32_t index);
+    void cascade(std::size_t bucket);
+    std::uint64_t next_event(std::uint64_t limit) const;
+    timer_handle insert(std::uint64_t deadline, callback_type callback, void *context,
+                        discard_type discard);
+
+public:
+    /**
+     * Schedule \a callback to be called with \a context at \a when.
+     *
+     * A timer whose deadline has already passed fires as soon as the wheel
+     * reaches its next tick.
+     *
+     * If \a discard is given, the timer owns \a context: if it is cancelled
+     * or the wheel is destroyed before it fires, \a discard is called with
+     * \a context instead of \a callback.
+     *
+     * This function is thread-safe.
+     *
+     * @throws std::bad_alloc if the slot map needs to grow and cannot.
+     * @return A handle to cancel the timer.
+     */
+    timer_handle schedule_at(time_point when, callback_type callback, void *context,
+                             discard_type discard = nullptr);
+
+    /**
+     * Schedule \a callback to be called with \a context \a delay after the
+     * current time of the wheel.
+     *
+     * @see schedule_at()
+     */
+    timer_handle schedule_after(duration delay, callback_type callback, void *context,
+                                discard_type discard = nullptr);
+
+    /**
+     * Cancel the timer referred to by \a handle.
+     *
+     * If the callback of the timer is running on another thread, this
+     * function waits until it has returned, so that the context of the
+     * timer can be destroyed safely afterwards.
+     *
+     * This function is thread-safe.
+     *
+     * @return true if the timer was pending and will not fire.
+     */
+    bool cancel(timer_handle handle);
+
+    /**
+     * Advance the time of the wheel to \a now, calling the callbacks of all
+     * timers which expire on the way, in the order of their deadlines.
+     *
+     * If a callback throws, the exception is propagated; the timers which
+     * expired on the same tick fire on the next call.
+     *
+     * @return The number of callbacks which have been called.
+     */
+    std::size_t advance(time_point now = clock::now());
+
+    /**
+     * The current time of the wheel: the start of the last tick reached by
+     * advance().
+     */
+    time_point now() const;
+
+    /**
+     * The number of pending timers.
+     */
+    std::size_t size() const;
+
+    inline duration resolution() const
+    {
+        return m_resolution;
+    }
+
+    /**
+     * Arena for contexts owned by timers of this wheel.
+     */
+    inline slot_arena &payload_arena()
+    {
+        return m_payload_arena;
+    }
+
+};
+
+}
+
+#endif
@@ -0,0 +1,338 @@
+/**********************************************************************
+File name: topic_bus.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_TOPIC_BUS_H
+#define SIG11_TOPIC_BUS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sig11/lock_policy.hpp"
+#include "sig11/sig11.hpp"
+
+
+namespace sig11 {
+
+namespace detail {
+
+/**
+ * A level of a topic, pointing into the topic string.
+ */
+struct topic_segment
+{
+    const char *data;
+    std::size_t size;
+};
+
+/**
+ * Orders std::string and topic_segment keys alike, so that a trie level
+ * can be searched with a topic_segment without allocating.
+ */
+struct topic_segment_less
+{
+    using is_transparent = void;
+
+    static inline int compare(const char *a, std::size_t a_size,
+                              const char *b, std::size_t b_size)
+    {
+        const int result = std::memcmp(a, b, std::min(a_size, b_size));
+        if (result != 0) {
+            return result;
+        }
+        return a_size < b_size ? -1 : (a_size > b_size ? 1 : 0);
+    }
+
+    inline bool operator()(const std::string &a, const std::string &b) const
+    {
+        return a < b;
+    }
+
+    inline bool operator()(const std::string &a, const topic_segment &b) const
+    {
+        return compare(a.data(), a.size(), b.data, b.size) < 0;
+    }
+
+    inline bool operator()(const topic_segment &a, const std::string &b) const
+    {
+        return compare(a.data, a.size, b.data(), b.size()) < 0;
+    }
+};
+
+}
+
+
+/**
+ * A topic_bus dispatches emissions to receivers by hierarchical topic.
+ *
+ * Topics are paths of levels separated by `/`, like `orders/eu/filled`.
+ * Receivers subscribe to a pattern, which is a topic in which a level may
+ * be `*` (matching exactly one level) or, as the last level, `#` (matching
+ * any number of levels, including none).
+ *
+ * The patterns are compiled into a trie at subscribe time; each trie node
+ * owns the signal for the receivers of its pattern. publish() walks the
+ * trie once along the levels of the topic, following the literal, `*` and
+ * `#` children, and emits the signals of all nodes it reaches. It does not
+ * match the topic against the individual patterns and does not allocate
+ * (except for the first publish at a new nesting depth).
+ *
+ * Trie nodes are never removed, so that the connection_guard objects
+ * returned by subscribe() stay valid for the lifetime of the bus.
+ *
+ * subscribe() is thread-safe. As with signal, no two threads must call
+ * publish() without synchronization; receivers may publish recursively
+ * and may subscribe and unsubscribe.
+ */
+template <typename T, typename mutex_t = shared_mutex>
+class topic_bus;
+
+template <typename result_t, typename... arg_ts, typename mutex_t>
+class topic_bus<result_t(arg_ts...), mutex_t>
+{
+public:
+    using call_t = result_t(arg_ts...);
+    using signal_type = signal<call_t>;
+    using guard_t = connection_guard<call_t>;
+
+public:
+    topic_bus():
+        m_depth(0)
+    {
+
+    }
+
+    topic_bus(const topic_bus &ref) = delete;
+    topic_bus &operator=(const topic_bus &ref) = delete;
+    topic_bus(topic_bus &&src) = delete;
+    topic_bus &operator=(topic_bus &&src) = delete;
+
+private:
+    struct node
+    {
+        signal_type signal;
+        std::map<std::string, std::unique_ptr<node>, detail::topic_segment_less> children;
+
+        /**
+         * Child for a `*` level.
+         */
+        std::unique_ptr<node> any_level;
+
+        /**
+         * Child for a trailing `#` level.
+         */
+        std::unique_ptr<node> any_suffix;
+    };
+
+    using segment_list = std::vector<detail::topic_segment>;
+    using match_list = std::vector<signal_type*>;
+
+    mutable mutex_t m_mutex;
+    node m_root;
+
+    struct scratch
+    {
+        segment_list segments;
+        match_list matches;
+    };
+
+    /**
+     * Scratch buffers for publish(), indexed by nesting depth; created by
+     * the first publish() at each depth.
+     */
+    std::vector<std::unique_ptr<scratch> > m_scratch;
+    std::size_t m_depth;
+
+    /**
+     * Publish depth tracking, which also keeps the scratch buffers of the
+     * outer publish() calls intact.
+     */
+    class depth_guard
+    {
+    public:
+        explicit depth_guard(std::size_t &depth):
+            m_depth(depth)
+        {
+            ++m_depth;
+        }
+
+        ~depth_guard()
+        {
+            --m_depth;
+        }
+
+    private:
+        std::size_t &m_depth;
+    };
+
+    static void split(const std::string &topic, segment_list &segments)
+    {
+        segments.clear();
+        std::size_t begin = 0;
+        for (;;) {
+            std::size_t end = topic.find('/', begin);
+            if (end == std::string::npos) {
+                end = topic.size();
+            }
+            segments.push_back(detail::topic_segment{topic.data() + begin, end - begin});
+            if (end == topic.size()) {
+                return;
+            }
+            begin = end + 1;
+        }
+    }
+
+    static void collect(node &at, const segment_list &segments, std::size_t level,
+                        match_list &matches)
+    {
+        if (at.any_suffix) {
+            matches.push_back(&at.any_suffix->signal);
+        }
+        if (level == segments.size()) {
+            matches.push_back(&at.signal);
+            return;
+        }
+        auto iter = at.children.find(segments[level]);
+        if (iter != at.children.end()) {
+            collect(*iter->second, segments, level + 1, matches);
+        }
+        if (at.any_level) {
+            collect(*at.any_level, segments, level + 1, matches);
+        }
+    }
+
+    /**
+     * Find or create the trie node for \a pattern.
+     *
+     * @throws std::invalid_argument if \a pattern has a `#` level which is
+     * not the last level, or a level which mixes wildcards with other
+     * characters.
+     */
+    node &node_for(const std::string &pattern)
+    {
+        segment_list segments;
+        split(pattern, segments);
+
+        std::lock_guard<mutex_t> lock(m_mutex);
+        node *at = &m_root;
+        for (std::size_t i = 0; i < segments.size(); ++i) {
+            const std::string level(segments[i].data, segments[i].size);
+            std::unique_ptr<node> *child = nullptr;
+            if (level == "#") {
+                if (i + 1 != segments.size()) {
+                    throw std::invalid_argument("# must be the last level of a pattern: " + pattern);
+                }
+                child = &at->any_suffix;
+            } else if (level == "*") {
+                child = &at->any_level;
+            } else if (level.find_first_of("*#") != std::string::npos) {
+                throw std::invalid_argument("wildcards must span a whole level: " + pattern);
+            } else {
+                child = &at->children[level];
+            }
+            if (!*child) {
+                child->reset(new node());
+            }
+            at = child->get();
+        }
+        return *at;
+    }
+
+public:
+    /**
+     * Connect a \a receiver to all topics matching \a pattern.
+     *
+     * This function is thread-safe.
+     *
+     * @throws std::invalid_argument if \a pattern is malformed.
+     * @return A connection_guard which unsubscribes the receiver.
+     */
+    template <typename callable_t>
+    guard_t subscribe [[gnu::warn_unused_result]] (const std::string &pattern,
+                                                   callable_t &&receiver)
+    {
+        signal_type &target = node_for(pattern).signal;
+        return guard_t(target.connect(std::forward<callable_t>(receiver)), target);
+    }
+
+    /**
+     * The signal which is emitted for the topics matching \a pattern.
+     *
+     * It can be used to connect receivers with connection objects, or to
+     * forward to other signals. It lives as long as the bus.
+     *
+     * @throws std::invalid_argument if \a pattern is malformed.
+     */
+    signal_type &topic(const std::string &pattern)
+    {
+        return node_for(pattern).signal;
+    }
+
+    /**
+     * Emit the given arguments to all receivers whose pattern matches
+     * \a topic.
+     *
+     * The signals of the matching patterns are emitted one after the
+     * other, in an unspecified order. Patterns without receivers (for
+     * example trie nodes which only lead to longer patterns, or whose
+     * receivers have all unsubscribed) are skipped.
+     *
+     * @return The number of matching patterns which had receivers.
+     */
+    std::size_t publish(const std::string &topic, const arg_ts&... args)
+    {
+        if (m_scratch.size() <= m_depth) {
+            m_scratch.emplace_back(new scratch());
+        }
+        // the vector may grow in nested calls, the scratch objects stay put
+        segment_list &segments = m_scratch[m_depth]->segments;
+        match_list &matches = m_scratch[m_depth]->matches;
+        depth_guard guard(m_depth);
+
+        split(topic, segments);
+        matches.clear();
+        {
+            detail::shared_lock_guard<mutex_t> lock(m_mutex);
+            collect(m_root, segments, 0, matches);
+        }
+        std::size_t emitted = 0;
+        for (signal_type *match: matches) {
+            if (match->emit(args...)) {
+                ++emitted;
+            }
+        }
+        return emitted;
+    }
+
+};
+
+}
+
+#endif
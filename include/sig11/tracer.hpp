@@ -0,0 +1,201 @@
+/**********************************************************************
+File name: tracer.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_TRACER_H
+#define SIG11_TRACER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace sig11 {
+
+typedef uint64_t token_id;
+
+/**
+ * The null_tracer is the default tracer policy of signal and defines the
+ * interface which tracer policies have to implement.
+ *
+ * A signal owns one instance of its tracer and calls the hooks around each
+ * emission and each receiver call. Each connected receiver additionally
+ * carries an instance of `tracer_t::slot_state`, which is passed to the
+ * per-slot hooks, so that a tracer can keep per-connection data without any
+ * lookup.
+ *
+ * The emission hooks (on_emit_begin(), on_slot_begin(), on_slot_end() and
+ * on_emit_end()) are called from the emitting thread without any lock held.
+ * on_connect() and on_disconnect() are called from the thread which
+ * connects or disconnects, with the mutex of the signal held. For a
+ * receiver connected with signal::connect_once(), on_disconnect() is called
+ * by the emitting thread, without the lock, right before on_slot_begin().
+ * If a receiver throws, the remaining hooks of that emission are not
+ * called.
+ *
+ * All hooks of the null_tracer are empty inline functions and slot_state is
+ * an empty class, so that a signal with the default tracer compiles to the
+ * same code as one without any tracing support. The hooks accept any
+ * slot_state type, so that tracers can derive from null_tracer and only
+ * define the hooks they need.
+ */
+struct null_tracer
+{
+    /**
+     * Per-connection state of the tracer.
+     */
+    struct slot_state
+    {
+    };
+
+    /**
+     * A receiver has been connected under the token \a id.
+     */
+    template <typename slot_state_t>
+    inline void on_connect(token_id, slot_state_t&)
+    {
+
+    }
+
+    /**
+     * The receiver with the token \a id has been disconnected.
+     */
+    template <typename slot_state_t>
+    inline void on_disconnect(token_id, slot_state_t&)
+    {
+
+    }
+
+    /**
+     * An emission is about to call the connected receivers.
+     */
+    inline void on_emit_begin()
+    {
+
+    }
+
+    /**
+     * The receiver with the token \a id is about to be called.
+     */
+    template <typename slot_state_t>
+    inline void on_slot_begin(token_id, slot_state_t&)
+    {
+
+    }
+
+    /**
+     * The receiver with the token \a id has returned.
+     */
+    template <typename slot_state_t>
+    inline void on_slot_end(token_id, slot_state_t&)
+    {
+
+    }
+
+    /**
+     * All receivers of an emission have been called.
+     */
+    inline void on_emit_end()
+    {
+
+    }
+};
+
+namespace detail {
+
+/**
+ * Start times (or other per-call records \a entry_t) of the receiver calls
+ * in progress, for tracers which time receivers.
+ *
+ * A receiver which emits the signal again nests another call, so the start
+ * times form a stack. It has a fixed capacity, so that timing never
+ * allocates on the emission path: pushing onto a full stack overwrites the
+ * oldest entry, whose call then goes untimed. This also discards the
+ * entries which are left behind when a receiver throws (on_slot_end() is
+ * not called then) once they are deep enough to matter.
+ */
+template <typename entry_t>
+class slot_start_stack
+{
+public:
+    static constexpr std::size_t capacity = 16;
+
+public:
+    slot_start_stack():
+        m_top(0),
+        m_size(0)
+    {
+
+    }
+
+private:
+    std::array<entry_t, capacity> m_starts;
+    std::size_t m_top;
+    std::size_t m_size;
+
+public:
+    inline void push(entry_t start)
+    {
+        m_starts[m_top] = start;
+        m_top = (m_top + 1) % capacity;
+        if (m_size < capacity) {
+            ++m_size;
+        }
+    }
+
+    /**
+     * The entry of the innermost call in progress, or nullptr.
+     */
+    inline entry_t *top()
+    {
+        if (m_size == 0) {
+            return nullptr;
+        }
+        return &m_starts[(m_top + capacity - 1) % capacity];
+    }
+
+    /**
+     * Pop the start time of the innermost call into \a start.
+     *
+     * @return false if the call was not timed.
+     */
+    inline bool pop(entry_t &start)
+    {
+        if (m_size == 0) {
+            return false;
+        }
+        m_top = (m_top + capacity - 1) % capacity;
+        --m_size;
+        start = m_starts[m_top];
+        return true;
+    }
+
+};
+
+template <typename entry_t>
+constexpr std::size_t slot_start_stack<entry_t>::capacity;
+
+}
+
+}
+
+#endif
@@ -0,0 +1,307 @@
+/**********************************************************************
+File name: wait_free_signal.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_WAIT_FREE_SIGNAL_H
+#define SIG11_WAIT_FREE_SIGNAL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "sig11/sig11.hpp"
+
+
+namespace sig11 {
+
+template <typename T>
+class wait_free_signal;
+
+/**
+ * A wait_free_signal is a signal whose emission is wait-free.
+ *
+ * Emission takes a bounded number of steps (two atomic increments, one
+ * atomic load and one call per connected receiver), takes no locks and does
+ * not allocate, regardless of what other threads do to the set of receivers
+ * at the same time. An emitter can therefore never be blocked by a lower
+ * priority thread which connects or disconnects a receiver.
+ *
+ * The synchronization cost is moved to the writers: connect() and
+ * disconnect() serialize on a mutex, build a new immutable list of receivers
+ * and publish it atomically. The previous list (and the receiver, on
+ * disconnect) is retired and only freed by a later writer once the emitter
+ * is known not to use it anymore. Writers never wait for the emitter, so it
+ * is also safe to connect and disconnect from within a receiver.
+ *
+ * As with signal, no two threads must emit a wait_free_signal without
+ * synchronization, but a receiver may emit the signal recursively. An
+ * emission which is in progress while a receiver is connected or
+ * disconnected uses the set of receivers from before the change.
+ */
+template <typename result_t, typename... arg_ts>
+class wait_free_signal<result_t(arg_ts...)>
+{
+public:
+    static_assert(std::is_void<result_t>::value,
+                  "signals with non-void return values are not supported.");
+
+    using call_t = result_t(arg_ts...);
+    using function_type = std::function<call_t>;
+    using guard_t = connection_guard<call_t>;
+
+public:
+    /**
+     * Construct a new signal without any connected receivers.
+     */
+    wait_free_signal():
+        m_token_id_ctr(0),
+        m_current(new snapshot()),
+        m_emitting(0),
+        m_epoch(0)
+    {
+
+    }
+
+    wait_free_signal(const wait_free_signal &ref) = delete;
+    wait_free_signal &operator=(const wait_free_signal &ref) = delete;
+    wait_free_signal(wait_free_signal &&src) = delete;
+    wait_free_signal &operator=(wait_free_signal &&src) = delete;
+
+    ~wait_free_signal()
+    {
+        snapshot *current = m_current.load();
+        for (listener *entry: current->listeners) {
+            delete entry;
+        }
+        delete current;
+        for (auto &item: m_retired) {
+            delete item.snap;
+            delete item.entry;
+        }
+    }
+
+private:
+    struct listener
+    {
+        token_id token;
+        function_type fn;
+    };
+
+    struct snapshot
+    {
+        std::vector<listener*> listeners;
+    };
+
+    struct retired
+    {
+        std::uint64_t epoch;
+        snapshot *snap;
+        listener *entry;
+    };
+
+    /**
+     * Tracks the emissions in progress and increments the epoch when the
+     * outermost emission begins and ends, even if a receiver throws.
+     *
+     * Recursive emissions only change the counter, so that the epoch stays
+     * odd until the outermost emission, which may still read the snapshot
+     * it has loaded, has finished.
+     */
+    class emit_guard
+    {
+    public:
+        explicit emit_guard(wait_free_signal &owner):
+            m_owner(owner)
+        {
+            if (m_owner.m_emitting++ == 0) {
+                m_owner.m_epoch.fetch_add(1, std::memory_order_seq_cst);
+            }
+        }
+
+        ~emit_guard()
+        {
+            if (--m_owner.m_emitting == 0) {
+                m_owner.m_epoch.fetch_add(1, std::memory_order_release);
+            }
+        }
+
+    private:
+        wait_free_signal &m_owner;
+    };
+
+    /* only accessed by writers, under m_writer_mutex */
+    std::mutex m_writer_mutex;
+    token_id m_token_id_ctr;
+    std::vector<retired> m_retired;
+
+    std::atomic<snapshot*> m_current;
+
+    /**
+     * Number of emissions in progress (the nesting depth); only accessed by
+     * the emitting thread.
+     */
+    std::size_t m_emitting;
+
+    /**
+     * Odd while an emission is in progress.
+     */
+    std::atomic<std::uint64_t> m_epoch;
+
+    void publish(snapshot *next, listener *removed)
+    {
+        snapshot *prev = m_current.exchange(next, std::memory_order_seq_cst);
+        const std::uint64_t epoch = m_epoch.load(std::memory_order_seq_cst);
+        m_retired.push_back(retired{epoch, prev, removed});
+        reclaim();
+    }
+
+    void reclaim()
+    {
+        const std::uint64_t epoch = m_epoch.load(std::memory_order_seq_cst);
+        auto keep = m_retired.begin();
+        for (auto iter = m_retired.begin(); iter != m_retired.end(); ++iter) {
+            // if the emitter was idle when the item was retired, or has
+            // finished the emission it was in, it cannot hold the old
+            // snapshot anymore
+            if ((iter->epoch & 1) == 0 || iter->epoch != epoch) {
+                delete iter->snap;
+                delete iter->entry;
+            } else {
+                *keep++ = *iter;
+            }
+        }
+        m_retired.erase(keep, m_retired.end());
+    }
+
+public:
+    /**
+     * Emit the signal with the given arguments.
+     *
+     * This function is wait-free and does not allocate (the receivers
+     * themselves may do either).
+     *
+     * No two threads must call this function without synchronization.
+     */
+    void operator()(const arg_ts&... args)
+    {
+        emit_guard guard(*this);
+        const snapshot *current = m_current.load(std::memory_order_seq_cst);
+        for (listener *entry: current->listeners) {
+            entry->fn(args...);
+        }
+    }
+
+    /**
+     * Connect a \a receiver to the signal.
+     *
+     * This function is thread-safe and never blocks an emitter. It copies the
+     * list of receivers and is thus O(n).
+     *
+     * @param receiver The std::function object to connect.
+     * @return A connection for the newly connected receiver.
+     * @see disconnect()
+     * @see sig11::connect()
+     */
+    connection connect(function_type &&receiver)
+    {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        const snapshot *current = m_current.load(std::memory_order_relaxed);
+        token_id token = m_token_id_ctr++;
+
+        snapshot *next = new snapshot();
+        try {
+            next->listeners.reserve(current->listeners.size() + 1);
+            next->listeners = current->listeners;
+            m_retired.reserve(m_retired.size() + 1);
+            // nothing may throw after the listener is allocated; the
+            // push_back does not reallocate
+            next->listeners.push_back(new listener{token, std::move(receiver)});
+        } catch (...) {
+            delete next;
+            throw;
+        }
+
+        publish(next, nullptr);
+        return connection(token);
+    }
+
+    /**
+     * Disconnect a given connection \a conn from the signal.
+     *
+     * If the \a conn is not valid or refers to a non-existent connection, this
+     * is a no-op.
+     *
+     * This function is thread-safe and never blocks an emitter. It copies the
+     * list of receivers and is thus O(n).
+     *
+     * @param conn The connection to disconnect.
+     */
+    void disconnect(connection &conn)
+    {
+        if (!conn) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        const snapshot *current = m_current.load(std::memory_order_relaxed);
+        auto iter = std::find_if(current->listeners.begin(),
+                                 current->listeners.end(),
+                                 [&conn](const listener *entry){ return entry->token == conn.id(); });
+        if (iter == current->listeners.end()) {
+            return;
+        }
+        listener *removed = *iter;
+
+        snapshot *next = new snapshot();
+        try {
+            next->listeners.reserve(current->listeners.size() - 1);
+            next->listeners.insert(next->listeners.end(), current->listeners.begin(), iter);
+            next->listeners.insert(next->listeners.end(), iter + 1, current->listeners.end());
+            m_retired.reserve(m_retired.size() + 1);
+        } catch (...) {
+            delete next;
+            throw;
+        }
+
+        publish(next, removed);
+        conn = nullptr;
+    }
+
+};
+
+
+/**
+ * Connect a \a receiver to a wait_free_signal and return a connection_guard
+ * for the new connection.
+ */
+template <typename call_t, typename callable_t>
+static inline connection_guard<call_t> connect [[gnu::warn_unused_result]] (wait_free_signal<call_t> &signal,
+                                                                            callable_t &&receiver)
+{
+    return connection_guard<call_t>(signal.connect(std::forward<callable_t>(receiver)), signal);
+}
+
+}
+
+#endif
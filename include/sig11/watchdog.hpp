@@ -0,0 +1,201 @@
+/**********************************************************************
+File name: watchdog.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_WATCHDOG_H
+#define SIG11_WATCHDOG_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "sig11/sig11.hpp"
+
+
+namespace sig11 {
+
+/**
+ * Tracer policy which reports receivers that exceed a time budget.
+ *
+ * Each signal using the watchdog_tracer has a name, a default budget and a
+ * callback. Individual connections can override the default budget with
+ * set_slot_budget(). When a receiver returns after taking longer than its
+ * budget, the callback is invoked on the emitting thread with the name of
+ * the signal, the token_id of the connection and the elapsed time. No
+ * monitoring thread is involved, so a receiver which blocks forever is not
+ * reported; the watchdog is meant to find receivers which regularly take
+ * too long (for example because they block on I/O).
+ *
+ * A connection without its own budget uses the default budget; if that is
+ * zero, such connections are not checked at all. To exempt a single
+ * connection whatever the default is, give it the budget unlimited().
+ *
+ *     sig11::signal<void(int), sig11::watchdog_tracer> signal(
+ *         "orders", std::chrono::milliseconds(1),
+ *         [](const std::string &name, sig11::token_id id,
+ *            std::chrono::nanoseconds elapsed) { ... });
+ */
+class watchdog_tracer: public null_tracer
+{
+public:
+    using clock = std::chrono::steady_clock;
+    using callback_type = std::function<void(const std::string &signal_name,
+                                             token_id id,
+                                             std::chrono::nanoseconds elapsed)>;
+
+    /**
+     * Per-connection budget; zero (the initial value) means that the
+     * default budget of the signal applies.
+     */
+    class slot_state
+    {
+    public:
+        slot_state():
+            m_budget_ns(0)
+        {
+
+        }
+
+    private:
+        std::atomic<std::int64_t> m_budget_ns;
+
+    public:
+        inline std::chrono::nanoseconds budget() const
+        {
+            return std::chrono::nanoseconds(m_budget_ns.load(std::memory_order_relaxed));
+        }
+
+        inline void set_budget(std::chrono::nanoseconds budget)
+        {
+            m_budget_ns.store(budget.count(), std::memory_order_relaxed);
+        }
+
+    };
+
+public:
+    /**
+     * @param name The name by which the signal is reported.
+     * @param default_budget The budget of connections without their own.
+     * @param on_exceeded The callback to invoke for slow receivers.
+     */
+    watchdog_tracer(std::string name,
+                    std::chrono::nanoseconds default_budget,
+                    callback_type on_exceeded):
+        m_name(std::move(name)),
+        m_default_budget_ns(default_budget.count()),
+        m_on_exceeded(std::move(on_exceeded))
+    {
+
+    }
+
+private:
+    const std::string m_name;
+    std::atomic<std::int64_t> m_default_budget_ns;
+    callback_type m_on_exceeded;
+    detail::slot_start_stack<clock::time_point> m_slot_starts;
+
+public:
+    /**
+     * A budget which is never exceeded, to exempt a connection from the
+     * check.
+     */
+    static constexpr std::chrono::nanoseconds unlimited()
+    {
+        return std::chrono::nanoseconds::max();
+    }
+
+    inline void on_slot_begin(token_id, slot_state&)
+    {
+        m_slot_starts.push(clock::now());
+    }
+
+    inline void on_slot_end(token_id id, slot_state &state)
+    {
+        clock::time_point start;
+        if (!m_slot_starts.pop(start)) {
+            return;
+        }
+        const std::chrono::nanoseconds elapsed = clock::now() - start;
+
+        std::chrono::nanoseconds budget = state.budget();
+        if (budget.count() == 0) {
+            budget = default_budget();
+        }
+        if (budget.count() > 0 && elapsed > budget && m_on_exceeded) {
+            m_on_exceeded(m_name, id, elapsed);
+        }
+    }
+
+    /**
+     * The name by which the signal is reported.
+     */
+    inline const std::string &name() const
+    {
+        return m_name;
+    }
+
+    /**
+     * The budget of connections which do not have their own.
+     */
+    inline std::chrono::nanoseconds default_budget() const
+    {
+        return std::chrono::nanoseconds(m_default_budget_ns.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * Change the budget of connections which do not have their own. Zero
+     * (like unlimited()) disables the check for them.
+     *
+     * This function is thread-safe.
+     */
+    inline void set_default_budget(std::chrono::nanoseconds budget)
+    {
+        m_default_budget_ns.store(budget.count(), std::memory_order_relaxed);
+    }
+
+};
+
+
+/**
+ * Give the connection \a conn of a watchdog-traced \a signal its own
+ * \a budget. A budget of zero reverts to the default budget of the signal;
+ * watchdog_tracer::unlimited() exempts the connection from the check.
+ *
+ * This function is thread-safe.
+ *
+ * @return true if the connection was found.
+ */
+template <typename call_t, typename mutex_t>
+static inline bool set_slot_budget(signal<call_t, watchdog_tracer, mutex_t> &signal,
+                                   const connection &conn,
+                                   std::chrono::nanoseconds budget)
+{
+    return signal.visit_slot_state(conn, [budget](watchdog_tracer::slot_state &state){
+        state.set_budget(budget);
+    });
+}
+
+}
+
+#endif
@@ -0,0 +1,187 @@
+/**********************************************************************
+File name: arena.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include "sig11/arena.hpp"
+
+namespace sig11 {
+
+static inline bool uses_arena(std::size_t size, std::size_t align)
+{
+    return size > 0 &&
+           size <= slot_arena::max_block_size &&
+           align <= slot_arena::granularity;
+}
+
+static inline std::size_t size_class(std::size_t size)
+{
+    return (size - 1) / slot_arena::granularity;
+}
+
+/* sig11::slot_arena::lock_guard */
+
+slot_arena::lock_guard::lock_guard(const slot_arena &arena):
+    m_mutex(arena.m_synchronized ? &arena.m_lock : nullptr)
+{
+    if (m_mutex) {
+        m_mutex->lock();
+    }
+}
+
+slot_arena::lock_guard::~lock_guard()
+{
+    if (m_mutex) {
+        m_mutex->unlock();
+    }
+}
+
+/* sig11::slot_arena */
+
+constexpr std::size_t slot_arena::granularity;
+constexpr std::size_t slot_arena::max_block_size;
+constexpr std::size_t slot_arena::chunk_size;
+constexpr slot_arena::single_threaded_t slot_arena::single_threaded;
+
+slot_arena::slot_arena():
+    m_synchronized(true),
+    m_owner(current_thread()),
+    m_local_in_use(0),
+    m_chunk_cursor(nullptr),
+    m_chunk_end(nullptr),
+    m_blocks_in_use(0)
+{
+    m_local_lists.fill(nullptr);
+    m_free_lists.fill(nullptr);
+}
+
+slot_arena::slot_arena(single_threaded_t):
+    m_synchronized(false),
+    m_owner(current_thread()),
+    m_local_in_use(0),
+    m_chunk_cursor(nullptr),
+    m_chunk_end(nullptr),
+    m_blocks_in_use(0)
+{
+    m_local_lists.fill(nullptr);
+    m_free_lists.fill(nullptr);
+}
+
+slot_arena::~slot_arena()
+{
+    for (char *chunk: m_chunks) {
+        ::operator delete(chunk);
+    }
+}
+
+void *slot_arena::carve(std::size_t cls)
+{
+    const std::size_t block_size = (cls + 1) * granularity;
+    if (m_chunk_cursor == nullptr ||
+            static_cast<std::size_t>(m_chunk_end - m_chunk_cursor) < block_size)
+    {
+        m_chunks.reserve(m_chunks.size() + 1);
+        char *chunk = static_cast<char*>(::operator new(chunk_size));
+        m_chunks.push_back(chunk);
+        m_chunk_cursor = chunk;
+        m_chunk_end = chunk + chunk_size;
+    }
+
+    void *result = m_chunk_cursor;
+    m_chunk_cursor += block_size;
+    return result;
+}
+
+void *slot_arena::allocate(std::size_t size, std::size_t align)
+{
+    if (!uses_arena(size, align)) {
+        return ::operator new(size);
+    }
+
+    const std::size_t cls = size_class(size);
+    if (is_owner()) {
+        free_block *block = m_local_lists[cls];
+        if (!block) {
+            // take over the blocks the other threads have freed
+            lock_guard lock(*this);
+            block = m_free_lists[cls];
+            m_free_lists[cls] = nullptr;
+            if (!block) {
+                block = static_cast<free_block*>(carve(cls));
+                block->next = nullptr;
+            }
+        }
+        m_local_lists[cls] = block->next;
+        m_local_in_use.store(m_local_in_use.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_relaxed);
+        return block;
+    }
+
+    lock_guard lock(*this);
+    ++m_blocks_in_use;
+    free_block *block = m_free_lists[cls];
+    if (block) {
+        m_free_lists[cls] = block->next;
+        return block;
+    }
+    return carve(cls);
+}
+
+void slot_arena::deallocate(void *ptr, std::size_t size, std::size_t align) noexcept
+{
+    if (!ptr) {
+        return;
+    }
+    if (!uses_arena(size, align)) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    const std::size_t cls = size_class(size);
+    free_block *block = static_cast<free_block*>(ptr);
+    if (is_owner()) {
+        block->next = m_local_lists[cls];
+        m_local_lists[cls] = block;
+        m_local_in_use.store(m_local_in_use.load(std::memory_order_relaxed) - 1,
+                             std::memory_order_relaxed);
+        return;
+    }
+
+    lock_guard lock(*this);
+    block->next = m_free_lists[cls];
+    m_free_lists[cls] = block;
+    --m_blocks_in_use;
+}
+
+std::size_t slot_arena::blocks_in_use() const
+{
+    lock_guard lock(*this);
+    return static_cast<std::size_t>(
+                m_blocks_in_use + m_local_in_use.load(std::memory_order_relaxed));
+}
+
+std::size_t slot_arena::reserved_bytes() const
+{
+    lock_guard lock(*this);
+    return m_chunks.size() * chunk_size;
+}
+
+}
@@ -0,0 +1,86 @@
+/**********************************************************************
+File name: event_loop.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include "sig11/event_loop.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+
+namespace sig11 {
+
+static int create_eventfd()
+{
+    const int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::system_category(), "eventfd");
+    }
+    return fd;
+}
+
+/* sig11::wakeup_fd */
+
+wakeup_fd::wakeup_fd():
+    m_fd(create_eventfd()),
+    m_pending(false)
+{
+
+}
+
+wakeup_fd::~wakeup_fd()
+{
+    ::close(m_fd);
+}
+
+void wakeup_fd::notify()
+{
+    if (m_pending.exchange(true)) {
+        return;
+    }
+    const std::uint64_t one = 1;
+    ssize_t result;
+    do {
+        result = ::write(m_fd, &one, sizeof(one));
+    } while (result < 0 && errno == EINTR);
+    // EAGAIN means the counter is saturated, so the descriptor is readable
+    // anyway
+}
+
+void wakeup_fd::consume()
+{
+    std::uint64_t value;
+    ssize_t result;
+    do {
+        result = ::read(m_fd, &value, sizeof(value));
+    } while (result < 0 && errno == EINTR);
+    // clear the flag only after the descriptor has been reset, so that a
+    // notify() which follows writes again; the exchange synchronizes with
+    // the notify() which set the flag
+    m_pending.exchange(false);
+}
+
+}
@@ -0,0 +1,160 @@
+/**********************************************************************
+File name: histogram.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include "sig11/histogram.hpp"
+
+#include <cmath>
+
+
+namespace sig11 {
+
+static inline unsigned magnitude(std::uint64_t value)
+{
+    return 63 - __builtin_clzll(value);
+}
+
+/* sig11::latency_histogram */
+
+constexpr unsigned latency_histogram::sub_bucket_bits;
+constexpr unsigned latency_histogram::max_magnitude;
+constexpr std::size_t latency_histogram::sub_buckets;
+constexpr std::size_t latency_histogram::bucket_count;
+constexpr std::uint64_t latency_histogram::max_trackable;
+
+latency_histogram::latency_histogram():
+    m_count(0),
+    m_total_ns(0),
+    m_max_ns(0)
+{
+    for (auto &bucket: m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::size_t latency_histogram::bucket_index(std::uint64_t ns)
+{
+    if (ns > max_trackable) {
+        ns = max_trackable;
+    }
+    if (ns < sub_buckets) {
+        return ns;
+    }
+    const unsigned mag = magnitude(ns);
+    const unsigned shift = mag - sub_bucket_bits;
+    const std::size_t sub = (ns >> shift) & (sub_buckets - 1);
+    return sub_buckets + shift * sub_buckets + sub;
+}
+
+std::uint64_t latency_histogram::bucket_upper_bound(std::size_t index)
+{
+    if (index < sub_buckets) {
+        return index;
+    }
+    const std::size_t shift = (index - sub_buckets) / sub_buckets;
+    const std::uint64_t sub = (index - sub_buckets) % sub_buckets;
+    const std::uint64_t lower = (sub_buckets + sub) << shift;
+    return lower + (std::uint64_t(1) << shift) - 1;
+}
+
+void latency_histogram::record(std::chrono::nanoseconds value)
+{
+    const std::uint64_t ns = value.count() > 0 ? value.count() : 0;
+    m_buckets[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total_ns.fetch_add(ns, std::memory_order_relaxed);
+    std::uint64_t prev_max = m_max_ns.load(std::memory_order_relaxed);
+    while (prev_max < ns &&
+           !m_max_ns.compare_exchange_weak(prev_max, ns, std::memory_order_relaxed))
+    {
+    }
+}
+
+void latency_histogram::reset()
+{
+    for (auto &bucket: m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_total_ns.store(0, std::memory_order_relaxed);
+    m_max_ns.store(0, std::memory_order_relaxed);
+}
+
+std::uint64_t latency_histogram::count() const
+{
+    return m_count.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds latency_histogram::total() const
+{
+    return std::chrono::nanoseconds(m_total_ns.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds latency_histogram::max() const
+{
+    return std::chrono::nanoseconds(m_max_ns.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds latency_histogram::mean() const
+{
+    const std::uint64_t n = count();
+    if (n == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    return std::chrono::nanoseconds(m_total_ns.load(std::memory_order_relaxed) / n);
+}
+
+std::chrono::nanoseconds latency_histogram::percentile(double percent) const
+{
+    // sum the buckets instead of using m_count, so that the result is
+    // consistent with the buckets we look at
+    std::uint64_t total = 0;
+    for (auto &bucket: m_buckets) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+
+    if (percent < 0) {
+        percent = 0;
+    } else if (percent > 100) {
+        percent = 100;
+    }
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(percent / 100.0 * total));
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            const std::uint64_t bound = bucket_upper_bound(i);
+            const std::uint64_t max_ns = m_max_ns.load(std::memory_order_relaxed);
+            return std::chrono::nanoseconds(bound < max_ns ? bound : max_ns);
+        }
+    }
+    return max();
+}
+
+}
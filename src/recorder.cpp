@@ -0,0 +1,120 @@
+/**********************************************************************
+File name: recorder.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include "sig11/recorder.hpp"
+
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace sig11 {
+
+namespace detail {
+
+static void *map_file(int fd, std::size_t size, bool writable, const std::string &path)
+{
+    const int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *data = ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        throw std::system_error(errno, std::system_category(), "mmap " + path);
+    }
+    return data;
+}
+
+/* sig11::detail::mapped_file */
+
+mapped_file::mapped_file(const std::string &path, std::size_t size):
+    m_fd(::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)),
+    m_writable(true),
+    m_size(size),
+    m_data(nullptr)
+{
+    if (m_fd < 0) {
+        throw std::system_error(errno, std::system_category(), "open " + path);
+    }
+    try {
+        if (::ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+            throw std::system_error(errno, std::system_category(), "ftruncate " + path);
+        }
+        m_data = map_file(m_fd, m_size, true, path);
+    } catch (...) {
+        ::close(m_fd);
+        throw;
+    }
+}
+
+mapped_file::mapped_file(const std::string &path):
+    m_fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC)),
+    m_writable(false),
+    m_size(0),
+    m_data(nullptr)
+{
+    if (m_fd < 0) {
+        throw std::system_error(errno, std::system_category(), "open " + path);
+    }
+    try {
+        struct stat info;
+        if (::fstat(m_fd, &info) != 0) {
+            throw std::system_error(errno, std::system_category(), "fstat " + path);
+        }
+        m_size = static_cast<std::size_t>(info.st_size);
+        if (m_size == 0) {
+            throw std::system_error(EINVAL, std::system_category(), "empty " + path);
+        }
+        m_data = map_file(m_fd, m_size, false, path);
+    } catch (...) {
+        ::close(m_fd);
+        throw;
+    }
+}
+
+mapped_file::~mapped_file()
+{
+    ::munmap(m_data, m_size);
+    ::close(m_fd);
+}
+
+void mapped_file::resize(std::size_t size)
+{
+    if (!m_writable) {
+        throw std::system_error(EBADF, std::system_category(), "resize of read-only mapping");
+    }
+    if (::ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+        throw std::system_error(errno, std::system_category(), "ftruncate");
+    }
+    void *data = ::mremap(m_data, m_size, size, MREMAP_MAYMOVE);
+    if (data == MAP_FAILED) {
+        throw std::system_error(errno, std::system_category(), "mremap");
+    }
+    m_data = data;
+    m_size = size;
+}
+
+}
+
+}
@@ -0,0 +1,283 @@
+/**********************************************************************
+File name: registry.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include "sig11/registry.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+
+namespace sig11 {
+
+static void write_prometheus_label(std::ostream &out, const std::string &value)
+{
+    for (char c: value) {
+        switch (c) {
+        case '\\':
+            out << "\\\\";
+            break;
+        case '"':
+            out << "\\\"";
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        default:
+            out << c;
+        }
+    }
+}
+
+static void write_json_string(std::ostream &out, const std::string &value)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    out << '"';
+    for (char c: value) {
+        switch (c) {
+        case '\\':
+            out << "\\\\";
+            break;
+        case '"':
+            out << "\\\"";
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        case '\r':
+            out << "\\r";
+            break;
+        case '\t':
+            out << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                out << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+            } else {
+                out << c;
+            }
+        }
+    }
+    out << '"';
+}
+
+template <typename writer_t>
+static bool write_file_atomically(const std::string &path, writer_t &&writer)
+{
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::out | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        writer(out);
+        out.flush();
+        if (!out) {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+/* sig11::signal_metrics */
+
+signal_metrics::signal_metrics(std::string name):
+    m_name(std::move(name)),
+    m_listeners(0),
+    m_emits(0),
+    m_slot_time_ns(0)
+{
+
+}
+
+/* sig11::signal_registry */
+
+signal_registry &signal_registry::instance()
+{
+    static signal_registry registry;
+    return registry;
+}
+
+void signal_registry::register_signal(const signal_metrics &metrics)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // with n signals registered, one of the indices 0..n is free
+    std::vector<bool> taken(m_signals.size() + 1, false);
+    for (const entry &item: m_signals) {
+        if (item.index < taken.size() && item.metrics->name() == metrics.name()) {
+            taken[item.index] = true;
+        }
+    }
+    const unsigned index = static_cast<unsigned>(
+                std::find(taken.begin(), taken.end(), false) - taken.begin());
+    m_signals.push_back(entry{&metrics, index});
+}
+
+void signal_registry::unregister_signal(const signal_metrics &metrics)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = std::find_if(m_signals.begin(), m_signals.end(),
+                             [&metrics](const entry &item){ return item.metrics == &metrics; });
+    if (iter != m_signals.end()) {
+        m_signals.erase(iter);
+    }
+}
+
+std::vector<signal_registry::sample> signal_registry::snapshot() const
+{
+    std::vector<sample> result;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    result.reserve(m_signals.size());
+    for (const entry &item: m_signals) {
+        const signal_metrics *metrics = item.metrics;
+        result.push_back(sample{metrics->name(),
+                                item.index,
+                                metrics->listeners(),
+                                metrics->emits(),
+                                metrics->slot_time()});
+    }
+    return result;
+}
+
+static void write_prometheus_labels(std::ostream &out, const signal_registry::sample &item)
+{
+    out << "{signal=\"";
+    write_prometheus_label(out, item.name);
+    out << "\"";
+    if (item.index > 0) {
+        out << ",index=\"" << item.index << "\"";
+    }
+    out << "}";
+}
+
+void signal_registry::write_prometheus(std::ostream &out) const
+{
+    const std::vector<sample> samples(snapshot());
+
+    out << "# HELP sig11_signal_listeners Number of receivers connected to the signal.\n"
+        << "# TYPE sig11_signal_listeners gauge\n";
+    for (const sample &item: samples) {
+        out << "sig11_signal_listeners";
+        write_prometheus_labels(out, item);
+        out << " " << item.listeners << "\n";
+    }
+
+    out << "# HELP sig11_signal_emits_total Number of emissions of the signal.\n"
+        << "# TYPE sig11_signal_emits_total counter\n";
+    for (const sample &item: samples) {
+        out << "sig11_signal_emits_total";
+        write_prometheus_labels(out, item);
+        out << " " << item.emits << "\n";
+    }
+
+    out << "# HELP sig11_signal_slot_seconds_total Time spent in the receivers of the signal.\n"
+        << "# TYPE sig11_signal_slot_seconds_total counter\n";
+    // the default of six significant digits would make the counter stall
+    const std::streamsize precision = out.precision(
+                std::numeric_limits<double>::max_digits10);
+    for (const sample &item: samples) {
+        out << "sig11_signal_slot_seconds_total";
+        write_prometheus_labels(out, item);
+        out << " " << std::chrono::duration<double>(item.slot_time).count() << "\n";
+    }
+    out.precision(precision);
+}
+
+void signal_registry::write_json(std::ostream &out) const
+{
+    const std::vector<sample> samples(snapshot());
+
+    out << "[";
+    bool first = true;
+    for (const sample &item: samples) {
+        if (!first) {
+            out << ",";
+        }
+        first = false;
+        out << "{\"name\":";
+        write_json_string(out, item.name);
+        if (item.index > 0) {
+            out << ",\"index\":" << item.index;
+        }
+        out << ",\"listeners\":" << item.listeners
+            << ",\"emits\":" << item.emits
+            << ",\"slot_time_ns\":" << item.slot_time.count()
+            << "}";
+    }
+    out << "]\n";
+}
+
+std::string signal_registry::to_prometheus() const
+{
+    std::ostringstream out;
+    write_prometheus(out);
+    return out.str();
+}
+
+std::string signal_registry::to_json() const
+{
+    std::ostringstream out;
+    write_json(out);
+    return out.str();
+}
+
+bool signal_registry::write_prometheus_file(const std::string &path) const
+{
+    return write_file_atomically(path, [this](std::ostream &out){ write_prometheus(out); });
+}
+
+bool signal_registry::write_json_file(const std::string &path) const
+{
+    return write_file_atomically(path, [this](std::ostream &out){ write_json(out); });
+}
+
+/* sig11::metrics_tracer */
+
+metrics_tracer::metrics_tracer(std::string name):
+    metrics_tracer(std::move(name), signal_registry::instance())
+{
+
+}
+
+metrics_tracer::metrics_tracer(std::string name, signal_registry &registry):
+    m_registry(registry),
+    m_metrics(std::move(name))
+{
+    m_registry.register_signal(m_metrics);
+}
+
+metrics_tracer::~metrics_tracer()
+{
+    m_registry.unregister_signal(m_metrics);
+}
+
+}
@@ -0,0 +1,170 @@
+/**********************************************************************
+File name: shm_signal.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include "sig11/shm_signal.hpp"
+
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <system_error>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+namespace sig11 {
+
+namespace detail {
+
+static void *map_shared(int fd, std::size_t size)
+{
+    void *data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        const int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::system_category(), "mmap");
+    }
+    ::close(fd);
+    return data;
+}
+
+/* sig11::detail::shm_region */
+
+shm_region::shm_region(const std::string &name, std::size_t size):
+    m_name(name),
+    m_owner(true),
+    m_device(0),
+    m_inode(0),
+    m_size(size),
+    m_data(nullptr)
+{
+    /* never truncate an existing object: processes which still have it
+     * mapped would fault on the truncated pages. A stale object (or one of
+     * another, live shm_signal) is unlinked instead and stays valid for
+     * everyone who has it mapped. */
+    ::shm_unlink(name.c_str());
+    const int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        throw std::system_error(errno, std::system_category(), "shm_open " + name);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        const int err = errno;
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        throw std::system_error(err, std::system_category(), "fstat " + name);
+    }
+    m_device = info.st_dev;
+    m_inode = info.st_ino;
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        const int err = errno;
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        throw std::system_error(err, std::system_category(), "ftruncate " + name);
+    }
+    try {
+        m_data = map_shared(fd, size);
+    } catch (...) {
+        ::shm_unlink(name.c_str());
+        throw;
+    }
+}
+
+shm_region::shm_region(const std::string &name):
+    m_name(name),
+    m_owner(false),
+    m_device(0),
+    m_inode(0),
+    m_size(0),
+    m_data(nullptr)
+{
+    const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw std::system_error(errno, std::system_category(), "shm_open " + name);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        const int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::system_category(), "fstat " + name);
+    }
+    m_size = static_cast<std::size_t>(info.st_size);
+    if (m_size == 0) {
+        ::close(fd);
+        throw std::system_error(EINVAL, std::system_category(), "empty " + name);
+    }
+    m_data = map_shared(fd, m_size);
+}
+
+shm_region::~shm_region()
+{
+    ::munmap(m_data, m_size);
+    if (m_owner && names_this_object()) {
+        ::shm_unlink(m_name.c_str());
+    }
+}
+
+bool shm_region::names_this_object() const
+{
+    // the name may have been taken over by a newer object meanwhile
+    const int fd = ::shm_open(m_name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    const bool same = ::fstat(fd, &info) == 0 &&
+            info.st_dev == m_device && info.st_ino == m_inode;
+    ::close(fd);
+    return same;
+}
+
+/* futex helpers */
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+              "futex words must be plain 32 bit integers");
+
+void futex_wait(std::atomic<std::uint32_t> &word, std::uint32_t expected,
+                std::chrono::nanoseconds timeout)
+{
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(seconds.count());
+    ts.tv_nsec = static_cast<long>((timeout - seconds).count());
+    // EAGAIN (word changed), EINTR and ETIMEDOUT all mean: check again
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT,
+              expected, &ts, nullptr, 0);
+}
+
+void futex_wake_all(std::atomic<std::uint32_t> &word)
+{
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE,
+              INT_MAX, nullptr, nullptr, 0);
+}
+
+}
+
+}
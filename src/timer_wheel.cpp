@@ -0,0 +1,324 @@
+/**********************************************************************
+File name: timer_wheel.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include "sig11/timer_wheel.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace sig11 {
+
+/* sig11::timer_wheel */
+
+constexpr unsigned timer_wheel::level_bits;
+constexpr std::size_t timer_wheel::slots_per_level;
+constexpr std::size_t timer_wheel::levels;
+constexpr std::uint32_t timer_wheel::npos;
+constexpr std::size_t timer_wheel::overflow_bucket;
+constexpr std::size_t timer_wheel::expired_bucket;
+constexpr std::size_t timer_wheel::bucket_count;
+
+timer_wheel::timer_wheel(duration resolution, time_point start):
+    m_resolution(resolution),
+    m_start(start),
+    m_free(npos),
+    m_active(0),
+    m_current(0)
+{
+    if (m_resolution.count() <= 0) {
+        throw std::invalid_argument("timer_wheel resolution must be positive");
+    }
+    m_buckets.fill(npos);
+}
+
+timer_wheel::~timer_wheel()
+{
+    for (entry &node: m_entries) {
+        if (node.bucket != npos && node.discard) {
+            node.discard(node.context);
+        }
+    }
+}
+
+std::uint64_t timer_wheel::tick_for(time_point when) const
+{
+    if (when <= m_start) {
+        return 0;
+    }
+    const duration::rep elapsed = (when - m_start).count();
+    return static_cast<std::uint64_t>((elapsed + m_resolution.count() - 1) / m_resolution.count());
+}
+
+std::size_t timer_wheel::bucket_for(std::uint64_t deadline) const
+{
+    for (std::size_t level = 0; level < levels; ++level) {
+        const unsigned shift = level_bits * static_cast<unsigned>(level);
+        // the slot of this level is reached before any of the higher
+        // levels changes
+        if ((deadline >> (shift + level_bits)) == (m_current >> (shift + level_bits))) {
+            return level * slots_per_level + ((deadline >> shift) & (slots_per_level - 1));
+        }
+    }
+    return overflow_bucket;
+}
+
+void timer_wheel::link(std::uint32_t index, std::size_t bucket)
+{
+    entry &node = m_entries[index];
+    node.bucket = static_cast<std::uint32_t>(bucket);
+    node.prev = npos;
+    node.next = m_buckets[bucket];
+    if (node.next != npos) {
+        m_entries[node.next].prev = index;
+    }
+    m_buckets[bucket] = index;
+}
+
+void timer_wheel::unlink(std::uint32_t index)
+{
+    entry &node = m_entries[index];
+    if (node.prev != npos) {
+        m_entries[node.prev].next = node.next;
+    } else {
+        m_buckets[node.bucket] = node.next;
+    }
+    if (node.next != npos) {
+        m_entries[node.next].prev = node.prev;
+    }
+    node.prev = npos;
+    node.next = npos;
+}
+
+void timer_wheel::release(std::uint32_t index)
+{
+    entry &node = m_entries[index];
+    node.bucket = npos;
+    node.callback = nullptr;
+    node.discard = nullptr;
+    node.context = nullptr;
+    if (++node.generation == 0) {
+        node.generation = 1;
+    }
+    node.next = m_free;
+    m_free = index;
+    --m_active;
+}
+
+void timer_wheel::cascade(std::size_t bucket)
+{
+    std::uint32_t index = m_buckets[bucket];
+    m_buckets[bucket] = npos;
+    while (index != npos) {
+        const std::uint32_t next = m_entries[index].next;
+        link(index, bucket_for(m_entries[index].deadline));
+        index = next;
+    }
+}
+
+/**
+ * Return the first tick after the current one at which a slot of the wheel
+ * is due, either to fire or to cascade, but at most \a limit.
+ */
+std::uint64_t timer_wheel::next_event(std::uint64_t limit) const
+{
+    std::uint64_t result = limit;
+    for (std::size_t level = 0; level < levels; ++level) {
+        const unsigned shift = level_bits * static_cast<unsigned>(level);
+        const std::uint64_t position = m_current >> shift;
+        const std::size_t current_slot = position & (slots_per_level - 1);
+        // the slots up to the current one are empty; their timers have been
+        // cascaded or fired already
+        for (std::size_t slot = current_slot + 1; slot < slots_per_level; ++slot) {
+            if (m_buckets[level * slots_per_level + slot] != npos) {
+                result = std::min(result, (position - current_slot + slot) << shift);
+                break;
+            }
+        }
+    }
+    if (m_buckets[overflow_bucket] != npos) {
+        const std::uint64_t top_mask = (std::uint64_t(1) << (level_bits * levels)) - 1;
+        result = std::min(result, (m_current | top_mask) + 1);
+    }
+    return result;
+}
+
+timer_handle timer_wheel::insert(std::uint64_t deadline, callback_type callback, void *context,
+                                 discard_type discard)
+{
+    deadline = std::max(deadline, m_current + 1);
+
+    std::uint32_t index = m_free;
+    if (index != npos) {
+        m_free = m_entries[index].next;
+    } else {
+        if (m_entries.size() >= npos) {
+            throw std::length_error("too many timers");
+        }
+        m_entries.push_back(entry{1, npos, npos, npos, 0, nullptr, nullptr, nullptr});
+        index = static_cast<std::uint32_t>(m_entries.size() - 1);
+    }
+
+    entry &node = m_entries[index];
+    node.deadline = deadline;
+    node.callback = callback;
+    node.discard = discard;
+    node.context = context;
+    link(index, bucket_for(deadline));
+    ++m_active;
+    return timer_handle(index, node.generation);
+}
+
+timer_handle timer_wheel::schedule_at(time_point when, callback_type callback, void *context,
+                                      discard_type discard)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return insert(tick_for(when), callback, context, discard);
+}
+
+timer_handle timer_wheel::schedule_after(duration delay, callback_type callback, void *context,
+                                         discard_type discard)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::uint64_t ticks = 0;
+    if (delay.count() > 0) {
+        ticks = static_cast<std::uint64_t>(
+                    (delay.count() + m_resolution.count() - 1) / m_resolution.count());
+    }
+    return insert(m_current + ticks, callback, context, discard);
+}
+
+bool timer_wheel::cancel(timer_handle handle)
+{
+    if (!handle) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (handle.index() < m_entries.size()) {
+        entry &node = m_entries[handle.index()];
+        if (node.generation == handle.generation() && node.bucket != npos) {
+            const discard_type discard = node.discard;
+            void *const context = node.context;
+            unlink(handle.index());
+            release(handle.index());
+            lock.unlock();
+            if (discard) {
+                discard(context);
+            }
+            return true;
+        }
+    }
+
+    // a callback may cancel its own timer without waiting for itself
+    if (m_running == handle && m_running_thread != std::this_thread::get_id()) {
+        m_callback_done.wait(lock, [this, handle](){ return m_running != handle; });
+    }
+    return false;
+}
+
+std::size_t timer_wheel::advance(time_point now)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    std::size_t fired = 0;
+    const std::uint64_t target = now > m_start
+            ? static_cast<std::uint64_t>((now - m_start).count() / m_resolution.count())
+            : 0;
+    const std::uint64_t top_mask = (std::uint64_t(1) << (level_bits * levels)) - 1;
+
+    for (;;) {
+        // timers which expired on the current tick; this includes timers
+        // left over when a callback has thrown
+        while (m_buckets[expired_bucket] != npos) {
+            const std::uint32_t index = m_buckets[expired_bucket];
+            unlink(index);
+            const callback_type callback = m_entries[index].callback;
+            void *const context = m_entries[index].context;
+            m_running = timer_handle(index, m_entries[index].generation);
+            m_running_thread = std::this_thread::get_id();
+            release(index);
+
+            lock.unlock();
+            try {
+                callback(context);
+            } catch (...) {
+                lock.lock();
+                m_running = timer_handle();
+                m_callback_done.notify_all();
+                throw;
+            }
+            lock.lock();
+            m_running = timer_handle();
+            m_callback_done.notify_all();
+            ++fired;
+        }
+
+        if (m_current >= target) {
+            break;
+        }
+        if (m_active == 0) {
+            m_current = target;
+            break;
+        }
+        // nothing happens on the ticks in between
+        m_current = next_event(target);
+
+        if ((m_current & top_mask) == 0) {
+            cascade(overflow_bucket);
+        }
+        for (std::size_t level = levels - 1; level > 0; --level) {
+            const unsigned shift = level_bits * static_cast<unsigned>(level);
+            if ((m_current & ((std::uint64_t(1) << shift) - 1)) != 0) {
+                continue;
+            }
+            cascade(level * slots_per_level + ((m_current >> shift) & (slots_per_level - 1)));
+        }
+
+        // move the due timers out of the wheel first, so that callbacks
+        // which schedule for the next tick do not end up in the list which
+        // is being fired
+        const std::size_t slot = m_current & (slots_per_level - 1);
+        std::uint32_t index = m_buckets[slot];
+        m_buckets[slot] = npos;
+        while (index != npos) {
+            const std::uint32_t next = m_entries[index].next;
+            link(index, expired_bucket);
+            index = next;
+        }
+    }
+    return fired;
+}
+
+timer_wheel::time_point timer_wheel::now() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_start + m_resolution * static_cast<duration::rep>(m_current);
+}
+
+std::size_t timer_wheel::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_active;
+}
+
+}
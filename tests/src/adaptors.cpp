@@ -0,0 +1,106 @@
+/**********************************************************************
+File name: adaptors.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/adaptors.hpp"
+
+#include "alloc_counter.hpp"
+
+#include <string>
+#include <vector>
+
+
+TEST_CASE("sig11/adaptors/filter_and_transform")
+{
+    sig11::signal<void(double)> prices;
+    std::vector<long> cents;
+
+    auto guard(sig11::connect(
+                   prices
+                   | sig11::filter([](double price){ return price > 10.0; })
+                   | sig11::transform([](double price){ return static_cast<long>(price * 100); }),
+                   [&cents](long value){ cents.push_back(value); }));
+
+    prices(5.0);
+    prices(12.5);
+    prices(10.0);
+    prices(20.25);
+    CHECK(cents == std::vector<long>({1250, 2025}));
+
+    guard.disconnect();
+    prices(30.0);
+    CHECK(cents.size() == 2);
+}
+
+TEST_CASE("sig11/adaptors/stages_apply_in_order")
+{
+    sig11::signal<void(int, int)> signal;
+    std::vector<std::string> received;
+
+    auto stream = signal
+            | sig11::filter([](int a, int b){ return a != b; })
+            | sig11::transform([](int a, int b){ return a * 10 + b; })
+            | sig11::filter([](int value){ return value % 2 == 0; })
+            | sig11::transform([](int value){ return std::to_string(value); });
+
+    sig11::connection conn(stream.connect([&received](const std::string &value){
+        received.push_back(value);
+    }));
+    auto guard(sig11::connect(stream, [&received](const std::string &value){
+        received.push_back("#" + value);
+    }));
+
+    signal(1, 1);
+    signal(1, 2);
+    signal(2, 1);
+    CHECK(received == std::vector<std::string>({"12", "#12"}));
+
+    signal.disconnect(conn);
+    signal(3, 4);
+    CHECK(received == std::vector<std::string>({"12", "#12", "#34"}));
+}
+
+TEST_CASE("sig11/adaptors/fused_into_one_receiver")
+{
+    sig11::signal<void(int)> signal;
+    int sum = 0;
+    int calls = 0;
+
+    auto guard(sig11::connect(
+                   signal
+                   | sig11::transform([](int value){ return value * 2; })
+                   | sig11::filter([](int value){ return value > 2; }),
+                   [&sum](int value){ sum += value; }));
+    signal.visit_slot_states([&calls](sig11::token_id, const sig11::null_tracer::slot_state&){
+        ++calls;
+    });
+    CHECK(calls == 1);
+
+    signal(1);
+    sig11::alloc_counter counter;
+    signal(2);
+    signal(3);
+    CHECK(counter.allocations() == 0);
+    CHECK(sum == 10);
+}
@@ -0,0 +1,101 @@
+/**********************************************************************
+File name: alloc_counter.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include "alloc_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+
+static thread_local std::size_t thread_allocations = 0;
+
+
+static void *counted_alloc(std::size_t size)
+{
+    ++thread_allocations;
+    if (size == 0) {
+        size = 1;
+    }
+    return std::malloc(size);
+}
+
+
+void *operator new(std::size_t size)
+{
+    void *result = counted_alloc(size);
+    if (!result) {
+        throw std::bad_alloc();
+    }
+    return result;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return counted_alloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return counted_alloc(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+
+namespace sig11 {
+
+alloc_counter::alloc_counter():
+    m_start(thread_allocations)
+{
+
+}
+
+std::size_t alloc_counter::allocations() const
+{
+    return thread_allocations - m_start;
+}
+
+}
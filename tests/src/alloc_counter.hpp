@@ -0,0 +1,57 @@
+/**********************************************************************
+File name: alloc_counter.hpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#ifndef SIG11_TESTS_ALLOC_COUNTER_H
+#define SIG11_TESTS_ALLOC_COUNTER_H
+
+#include <cstddef>
+
+
+namespace sig11 {
+
+/**
+ * Test harness which counts the heap allocations of the calling thread.
+ *
+ * The test binary replaces the global operator new; each call increments a
+ * thread-local counter. Create an alloc_counter before the code under test
+ * and check allocations() afterwards.
+ */
+class alloc_counter
+{
+public:
+    alloc_counter();
+
+private:
+    std::size_t m_start;
+
+public:
+    /**
+     * The number of allocations of the current thread since construction.
+     */
+    std::size_t allocations() const;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,274 @@
+/**********************************************************************
+File name: arena.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/sig11.hpp"
+
+#include "alloc_counter.hpp"
+
+#include <array>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+TEST_CASE("sig11/slot_arena/allocate_and_recycle")
+{
+    sig11::slot_arena arena;
+    CHECK(arena.blocks_in_use() == 0);
+    CHECK(arena.reserved_bytes() == 0);
+
+    void *a = arena.allocate(24, 8);
+    void *b = arena.allocate(24, 8);
+    CHECK(a != b);
+    CHECK(arena.blocks_in_use() == 2);
+    CHECK(arena.reserved_bytes() == sig11::slot_arena::chunk_size);
+
+    arena.deallocate(a, 24, 8);
+    CHECK(arena.blocks_in_use() == 1);
+
+    void *c = arena.allocate(32, 8);
+    CHECK(c == a);
+
+    arena.deallocate(b, 24, 8);
+    arena.deallocate(c, 32, 8);
+    CHECK(arena.blocks_in_use() == 0);
+}
+
+TEST_CASE("sig11/slot_arena/other_threads")
+{
+    sig11::slot_arena arena;
+    void *owned = arena.allocate(24, 8);
+    void *foreign = nullptr;
+
+    // another thread frees a block of the owner and allocates its own
+    std::thread other([&arena, &owned, &foreign](){
+        arena.deallocate(owned, 24, 8);
+        foreign = arena.allocate(24, 8);
+    });
+    other.join();
+    CHECK(foreign == owned);
+    CHECK(arena.blocks_in_use() == 1);
+
+    // blocks freed by other threads are reused by the owner
+    arena.deallocate(foreign, 24, 8);
+    std::thread other2([&arena](){
+        arena.deallocate(arena.allocate(24, 8), 24, 8);
+    });
+    other2.join();
+    CHECK(arena.blocks_in_use() == 0);
+    void *a = arena.allocate(24, 8);
+    void *b = arena.allocate(24, 8);
+    CHECK(a == owned);
+    CHECK(b != a);
+    arena.deallocate(a, 24, 8);
+    arena.deallocate(b, 24, 8);
+    CHECK(arena.blocks_in_use() == 0);
+    CHECK(arena.reserved_bytes() == sig11::slot_arena::chunk_size);
+}
+
+TEST_CASE("sig11/slot_arena/oversized_blocks_bypass_arena")
+{
+    sig11::slot_arena arena;
+
+    void *big = arena.allocate(sig11::slot_arena::max_block_size + 1, 8);
+    CHECK(arena.blocks_in_use() == 0);
+    CHECK(arena.reserved_bytes() == 0);
+    arena.deallocate(big, sig11::slot_arena::max_block_size + 1, 8);
+}
+
+TEST_CASE("sig11/slot_arena/arena_allocator")
+{
+    sig11::slot_arena arena;
+    sig11::arena_allocator<int> alloc1(&arena);
+    sig11::arena_allocator<long> alloc2(alloc1);
+    sig11::arena_allocator<int> heap_alloc;
+
+    CHECK(alloc1 == alloc2);
+    CHECK(alloc1 != heap_alloc);
+
+    std::vector<int, sig11::arena_allocator<int> > values(alloc1);
+    values.push_back(1);
+    CHECK(arena.blocks_in_use() == 1);
+    values.clear();
+    values.shrink_to_fit();
+    CHECK(arena.blocks_in_use() == 0);
+}
+
+TEST_CASE("sig11/slot_arena/signal_uses_arena")
+{
+    sig11::slot_arena arena;
+    std::string destination;
+    std::array<char, 64> padding{};
+
+    {
+        sig11::signal<void(const std::string&)> signal(arena);
+        auto fun = [&destination, padding](const std::string &value){ destination = value + padding.data(); };
+
+        sig11::connection conn(signal.connect(fun));
+        // the listener, the boxed receiver and the receiver list
+        CHECK(arena.blocks_in_use() == 3);
+
+        signal("foo");
+        CHECK(destination == "foo");
+        // plus the dispatch buffer
+        CHECK(arena.blocks_in_use() == 4);
+
+        // the boxed receiver is released, the listener stays as tombstone
+        signal.disconnect(conn);
+        CHECK(arena.blocks_in_use() == 3);
+
+        signal.connect(fun);
+        signal.connect([&destination](const std::string &value){ destination = value; });
+        CHECK(arena.blocks_in_use() == 6);
+
+        signal("bar");
+        CHECK(destination == "bar");
+    }
+
+    CHECK(arena.blocks_in_use() == 0);
+    CHECK(arena.reserved_bytes() == sig11::slot_arena::chunk_size);
+}
+
+TEST_CASE("sig11/slot_arena/signal_compacts_tombstones")
+{
+    sig11::slot_arena arena;
+    int calls = 0;
+
+    sig11::signal<void()> signal(arena);
+    signal.connect([&calls](){ ++calls; });
+
+    std::vector<sig11::connection> conns;
+    const std::size_t tombstones = sig11::signal<void()>::compact_min_tombstones;
+    for (std::size_t i = 0; i < tombstones; ++i) {
+        conns.emplace_back(signal.connect([&calls](){ ++calls; }));
+    }
+    signal();
+    CHECK(calls == static_cast<int>(tombstones) + 1);
+
+    const std::size_t blocks = arena.blocks_in_use();
+    for (std::size_t i = 0; i < tombstones - 1; ++i) {
+        signal.disconnect(conns[i]);
+    }
+    // tombstones keep their listener until the threshold is reached
+    CHECK(arena.blocks_in_use() == blocks);
+
+    signal.disconnect(conns.back());
+    CHECK(arena.blocks_in_use() == blocks - tombstones);
+
+    calls = 0;
+    signal();
+    CHECK(calls == 1);
+}
+
+TEST_CASE("sig11/slot_arena/disconnect_during_emit_compacts_afterwards")
+{
+    sig11::slot_arena arena;
+    std::vector<sig11::connection> conns;
+    int calls = 0;
+
+    sig11::signal<void()> signal(arena);
+    signal.connect([&conns, &signal](){
+        for (auto &conn: conns) {
+            signal.disconnect(conn);
+        }
+    });
+    signal();
+    const std::size_t blocks = arena.blocks_in_use();
+
+    for (int i = 0; i < 4; ++i) {
+        conns.emplace_back(signal.connect([&calls](){ ++calls; }));
+    }
+    CHECK(arena.blocks_in_use() == blocks + 4);
+    signal();
+    CHECK(calls == 0);
+    // all listeners disconnected during the emission are gone afterwards
+    CHECK(arena.blocks_in_use() == blocks);
+}
+
+TEST_CASE("sig11/slot_arena/signals_recycle_blocks")
+{
+    sig11::slot_arena arena;
+    int destination = 0;
+    std::array<char, 64> padding{};
+
+    for (int i = 0; i < 1000; ++i) {
+        sig11::signal<void(int)> signal(arena);
+        signal.connect([&destination, padding](int value){ destination = value + padding[0]; });
+        auto guard(sig11::connect(signal, [&destination, padding](int value){ destination = value + padding[0]; }));
+        signal(i);
+    }
+
+    CHECK(destination == 999);
+    CHECK(arena.blocks_in_use() == 0);
+    CHECK(arena.reserved_bytes() == sig11::slot_arena::chunk_size);
+}
+
+TEST_CASE("sig11/slot_arena/signal_lifecycle_does_not_allocate")
+{
+    sig11::slot_arena arena;
+    int destination = 0;
+    std::array<char, 64> padding{};
+
+    auto cycle = [&arena, &destination, padding](int value){
+        sig11::signal<void(int)> signal(arena);
+        sig11::connection conn(signal.connect(
+            [&destination, padding](int value){ destination = value + padding[0]; }));
+        signal(value);
+        signal.disconnect(conn);
+    };
+
+    // the first cycle carves the blocks out of the arena
+    cycle(1);
+
+    std::size_t allocations;
+    {
+        sig11::alloc_counter counter;
+        cycle(2);
+        {
+            sig11::signal<void(int)> plain;
+            plain(3);
+        }
+        allocations = counter.allocations();
+    }
+    CHECK(allocations == 0);
+    CHECK(destination == 2);
+}
+
+TEST_CASE("sig11/slot_arena/single_threaded")
+{
+    sig11::slot_arena arena(sig11::slot_arena::single_threaded);
+    int destination = 0;
+    std::array<char, 64> padding{};
+
+    for (int i = 0; i < 1000; ++i) {
+        sig11::signal<void(int)> signal(arena);
+        auto guard(sig11::connect(signal, [&destination, padding](int value){ destination = value + padding[0]; }));
+        signal(i);
+    }
+
+    CHECK(destination == 999);
+    CHECK(arena.blocks_in_use() == 0);
+    CHECK(arena.reserved_bytes() == sig11::slot_arena::chunk_size);
+}
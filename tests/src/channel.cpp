@@ -0,0 +1,413 @@
+/**********************************************************************
+File name: channel.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/channel.hpp"
+
+#include "alloc_counter.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+TEST_CASE("sig11/channel/push_and_pop")
+{
+    sig11::channel<int, std::string> channel(4);
+    CHECK(channel.capacity() == 4);
+    CHECK(channel.empty());
+
+    CHECK(channel.push(1, "a"));
+    CHECK(channel.push(2, "b"));
+    CHECK(!channel.empty());
+
+    std::tuple<int, std::string> value;
+    REQUIRE(channel.try_pop(value));
+    CHECK(value == std::make_tuple(1, std::string("a")));
+    REQUIRE(channel.try_pop(value));
+    CHECK(value == std::make_tuple(2, std::string("b")));
+    CHECK(!channel.try_pop(value));
+    CHECK(channel.empty());
+}
+
+TEST_CASE("sig11/channel/capacity_is_rounded_up")
+{
+    sig11::channel<int> channel(5);
+    CHECK(channel.capacity() == 8);
+}
+
+TEST_CASE("sig11/channel/try_pop_n")
+{
+    sig11::channel<int> channel(8);
+    for (int i = 0; i < 5; ++i) {
+        channel.push(i);
+    }
+
+    std::array<std::tuple<int>, 3> batch;
+    REQUIRE(channel.try_pop_n(batch.data(), batch.size()) == 3);
+    CHECK(std::get<0>(batch[0]) == 0);
+    CHECK(std::get<0>(batch[2]) == 2);
+
+    REQUIRE(channel.try_pop_n(batch.data(), batch.size()) == 2);
+    CHECK(std::get<0>(batch[0]) == 3);
+    CHECK(std::get<0>(batch[1]) == 4);
+
+    CHECK(channel.try_pop_n(batch.data(), batch.size()) == 0);
+}
+
+TEST_CASE("sig11/channel/drop_newest")
+{
+    sig11::channel<int> channel(2, sig11::overflow_policy::drop_newest);
+    CHECK(channel.push(1));
+    CHECK(channel.push(2));
+    CHECK(!channel.push(3));
+
+    std::array<std::tuple<int>, 4> batch;
+    REQUIRE(channel.try_pop_n(batch.data(), batch.size()) == 2);
+    CHECK(std::get<0>(batch[0]) == 1);
+    CHECK(std::get<0>(batch[1]) == 2);
+}
+
+TEST_CASE("sig11/channel/drop_oldest")
+{
+    sig11::channel<int> channel(2, sig11::overflow_policy::drop_oldest);
+    CHECK(channel.push(1));
+    CHECK(channel.push(2));
+    CHECK(channel.push(3));
+
+    std::array<std::tuple<int>, 4> batch;
+    REQUIRE(channel.try_pop_n(batch.data(), batch.size()) == 2);
+    CHECK(std::get<0>(batch[0]) == 2);
+    CHECK(std::get<0>(batch[1]) == 3);
+}
+
+TEST_CASE("sig11/channel/drop_counters")
+{
+    sig11::channel<int> newest(2, sig11::overflow_policy::drop_newest);
+    sig11::channel<int> oldest(2, sig11::overflow_policy::drop_oldest);
+    for (int i = 0; i < 5; ++i) {
+        newest.push(i);
+        oldest.push(i);
+    }
+    CHECK(newest.dropped() == 3);
+    CHECK(oldest.dropped() == 3);
+    CHECK(newest.coalesced() == 0);
+    CHECK(newest.rejected() == 0);
+    CHECK(newest.blocked() == 0);
+}
+
+TEST_CASE("sig11/channel/fail")
+{
+    sig11::channel<int> channel(2, sig11::overflow_policy::fail);
+    sig11::signal<void(int)> signal;
+    auto guard(sig11::connect(signal, channel));
+
+    signal(1);
+    signal(2);
+    CHECK_THROWS_AS(signal(3), sig11::channel_full);
+    CHECK(channel.rejected() == 1);
+    CHECK(channel.dropped() == 0);
+
+    std::array<std::tuple<int>, 4> batch;
+    REQUIRE(channel.try_pop_n(batch.data(), batch.size()) == 2);
+    CHECK(std::get<0>(batch[1]) == 2);
+}
+
+TEST_CASE("sig11/channel/coalesce")
+{
+    sig11::channel<std::string, int> channel(2, sig11::same_element<0>());
+    CHECK(channel.policy() == sig11::overflow_policy::coalesce);
+
+    CHECK(channel.push("a", 1));
+    CHECK(channel.push("b", 1));
+    CHECK(channel.push("a", 2));
+    CHECK(channel.push("b", 2));
+    CHECK(!channel.push("c", 1));
+    CHECK(channel.coalesced() == 2);
+    CHECK(channel.dropped() == 1);
+
+    std::array<std::tuple<std::string, int>, 4> batch;
+    REQUIRE(channel.try_pop_n(batch.data(), batch.size()) == 2);
+    CHECK(batch[0] == std::make_tuple(std::string("a"), 2));
+    CHECK(batch[1] == std::make_tuple(std::string("b"), 2));
+}
+
+TEST_CASE("sig11/channel/coalesce_needs_key")
+{
+    CHECK_THROWS_AS(sig11::channel<int>(2, sig11::overflow_policy::coalesce),
+                    std::invalid_argument);
+}
+
+TEST_CASE("sig11/channel/block")
+{
+    static const int items = 10000;
+
+    sig11::channel<int> channel(4, sig11::overflow_policy::block);
+    std::thread producer([&channel](){
+        for (int i = 0; i < items; ++i) {
+            channel.push(i);
+        }
+    });
+
+    std::vector<int> received;
+    std::array<std::tuple<int>, 8> batch;
+    while (received.size() < static_cast<std::size_t>(items)) {
+        const std::size_t n = channel.try_pop_n(batch.data(), batch.size());
+        for (std::size_t i = 0; i < n; ++i) {
+            received.push_back(std::get<0>(batch[i]));
+        }
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    bool in_order = true;
+    for (int i = 0; i < items; ++i) {
+        in_order = in_order && received[i] == i;
+    }
+    CHECK(in_order);
+    CHECK(channel.dropped() == 0);
+}
+
+TEST_CASE("sig11/channel/block_wakes_producer")
+{
+    sig11::channel<int> channel(2, sig11::overflow_policy::block);
+    CHECK(channel.push(1));
+    CHECK(channel.push(2));
+
+    std::atomic<bool> pushed(false);
+    std::thread producer([&channel, &pushed](){
+        channel.push(3);
+        pushed = true;
+    });
+    while (channel.blocked() == 0) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(!pushed.load());
+
+    std::tuple<int> value;
+    REQUIRE(channel.try_pop(value));
+    CHECK(std::get<0>(value) == 1);
+    producer.join();
+    CHECK(pushed.load());
+
+    REQUIRE(channel.try_pop(value));
+    CHECK(std::get<0>(value) == 2);
+    REQUIRE(channel.try_pop(value));
+    CHECK(std::get<0>(value) == 3);
+}
+
+TEST_CASE("sig11/channel/coalesce_concurrent")
+{
+    static const int items = 20000;
+    static const int keys = 4;
+
+    sig11::channel<int, int> channel(4, sig11::same_element<0>());
+    std::thread producer([&channel](){
+        for (int i = 0; i < items; ++i) {
+            channel.push(i % keys, i);
+        }
+        // the last value per key is always delivered
+        for (int key = 0; key < keys; ++key) {
+            while (!channel.push(key, items)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::vector<int> last(keys, -1);
+    bool monotonic = true;
+    int finished = 0;
+    std::array<std::tuple<int, int>, 8> batch;
+    while (finished < keys) {
+        const std::size_t n = channel.try_pop_n(batch.data(), batch.size());
+        for (std::size_t i = 0; i < n; ++i) {
+            const int key = std::get<0>(batch[i]);
+            const int value = std::get<1>(batch[i]);
+            monotonic = monotonic && value > last[key];
+            last[key] = value;
+            if (value == items) {
+                ++finished;
+            }
+        }
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    CHECK(monotonic);
+}
+
+TEST_CASE("sig11/channel/destroys_queued_values")
+{
+    auto value = std::make_shared<int>(42);
+    {
+        sig11::channel<std::shared_ptr<int> > channel(4);
+        channel.push(value);
+        channel.push(value);
+        CHECK(value.use_count() == 3);
+    }
+    CHECK(value.use_count() == 1);
+}
+
+TEST_CASE("sig11/channel/connect_to_signal")
+{
+    sig11::signal<void(int, const std::string&)> signal;
+    sig11::channel<int, std::string> channel(4);
+
+    {
+        auto guard(sig11::connect(signal, channel));
+        signal(1, "a");
+        signal(2, "b");
+    }
+    signal(3, "c");
+
+    std::array<std::tuple<int, std::string>, 4> batch;
+    REQUIRE(channel.try_pop_n(batch.data(), batch.size()) == 2);
+    CHECK(batch[0] == std::make_tuple(1, std::string("a")));
+    CHECK(batch[1] == std::make_tuple(2, std::string("b")));
+}
+
+TEST_CASE("sig11/channel/push_does_not_allocate")
+{
+    sig11::channel<int, double> channel(64);
+    std::tuple<int, double> value;
+
+    sig11::alloc_counter counter;
+    for (int i = 0; i < 1000; ++i) {
+        channel.push(i, 0.5);
+        channel.try_pop(value);
+    }
+    CHECK(counter.allocations() == 0);
+}
+
+TEST_CASE("sig11/channel/multiple_producers")
+{
+    static const int producers = 4;
+    static const int per_producer = 20000;
+
+    sig11::channel<int, int> channel(256);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&channel, p](){
+            for (int i = 0; i < per_producer; ++i) {
+                while (!channel.push(p, i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> next(producers, 0);
+    bool in_order = true;
+    int received = 0;
+    std::array<std::tuple<int, int>, 32> batch;
+    while (received < producers * per_producer) {
+        const std::size_t n = channel.try_pop_n(batch.data(), batch.size());
+        if (n == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            const int producer = std::get<0>(batch[i]);
+            in_order = in_order && std::get<1>(batch[i]) == next[producer];
+            next[producer] += 1;
+        }
+        received += static_cast<int>(n);
+    }
+
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    CHECK(in_order);
+    CHECK(channel.empty());
+}
+
+namespace {
+
+struct throwing_copy
+{
+    throwing_copy(int value, bool throws):
+        value(value),
+        throws(throws)
+    {
+
+    }
+
+    throwing_copy():
+        throwing_copy(0, false)
+    {
+
+    }
+
+    throwing_copy(const throwing_copy &ref):
+        value(ref.value),
+        throws(ref.throws)
+    {
+        if (throws) {
+            throw std::runtime_error("copy failed");
+        }
+    }
+
+    throwing_copy &operator=(const throwing_copy &ref) = default;
+
+    int value;
+    bool throws;
+};
+
+}
+
+TEST_CASE("sig11/channel/throwing_copy_is_skipped")
+{
+    sig11::channel<throwing_copy> channel(4);
+    CHECK(channel.push(throwing_copy(1, false)));
+    CHECK_THROWS_AS(channel.push(throwing_copy(2, true)), std::runtime_error);
+    CHECK(channel.push(throwing_copy(3, false)));
+    CHECK_THROWS_AS(channel.push(throwing_copy(4, true)), std::runtime_error);
+
+    std::tuple<throwing_copy> value;
+    REQUIRE(channel.try_pop(value));
+    CHECK(std::get<0>(value).value == 1);
+    REQUIRE(channel.try_pop(value));
+    CHECK(std::get<0>(value).value == 3);
+    CHECK(!channel.try_pop(value));
+    CHECK(channel.empty());
+
+    // the cells are usable again
+    CHECK_THROWS_AS(channel.push(throwing_copy(5, true)), std::runtime_error);
+    CHECK(channel.push(throwing_copy(6, false)));
+    std::array<std::tuple<throwing_copy>, 4> batch;
+    REQUIRE(channel.try_pop_n(batch.data(), batch.size()) == 1);
+    CHECK(std::get<0>(batch[0]).value == 6);
+    CHECK(channel.empty());
+}
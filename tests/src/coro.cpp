@@ -0,0 +1,172 @@
+/**********************************************************************
+File name: coro.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/coro.hpp"
+
+#include "alloc_counter.hpp"
+
+#include <string>
+#include <vector>
+
+
+/**
+ * Minimal eagerly started coroutine type which does not return a value.
+ */
+struct task
+{
+    struct promise_type
+    {
+        task get_return_object()
+        {
+            return task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void()
+        {
+
+        }
+
+        void unhandled_exception()
+        {
+            throw;
+        }
+    };
+
+    explicit task(std::coroutine_handle<promise_type> handle):
+        handle(handle)
+    {
+
+    }
+
+    task(const task &ref) = delete;
+    task &operator=(const task &ref) = delete;
+
+    ~task()
+    {
+        handle.destroy();
+    }
+
+    bool done() const
+    {
+        return handle.done();
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+
+static task collect(sig11::signal<void(int, const std::string&)> &signal,
+                    std::vector<std::string> &out,
+                    int count)
+{
+    for (int i = 0; i < count; ++i) {
+        auto [number, text] = co_await sig11::next(signal);
+        out.push_back(std::to_string(number) + text);
+    }
+}
+
+
+TEST_CASE("sig11/coro/next")
+{
+    sig11::signal<void(int, const std::string&)> signal;
+    std::vector<std::string> out;
+
+    task waiter(collect(signal, out, 2));
+    CHECK(!waiter.done());
+    CHECK(out.empty());
+
+    signal(1, "a");
+    CHECK(out == std::vector<std::string>({"1a"}));
+    CHECK(!waiter.done());
+
+    signal(2, "b");
+    CHECK(out == std::vector<std::string>({"1a", "2b"}));
+    CHECK(waiter.done());
+
+    signal(3, "c");
+    CHECK(out.size() == 2);
+}
+
+TEST_CASE("sig11/coro/next_and_receivers")
+{
+    sig11::signal<void(int, const std::string&)> signal;
+    std::vector<std::string> out;
+
+    signal.connect([&out](int number, const std::string &text){
+        out.push_back("slot " + std::to_string(number) + text);
+    });
+
+    task first(collect(signal, out, 1));
+    task second(collect(signal, out, 1));
+
+    signal(1, "a");
+    signal(2, "b");
+
+    CHECK(first.done());
+    CHECK(second.done());
+    CHECK(out == std::vector<std::string>({"1a", "1a", "slot 1a", "slot 2b"}));
+}
+
+TEST_CASE("sig11/coro/next_does_not_allocate")
+{
+    sig11::signal<void(int, const std::string&)> signal;
+    std::vector<std::string> out;
+    out.reserve(16);
+    const std::string text("x");
+
+    task waiter(collect(signal, out, 8));
+
+    sig11::alloc_counter counter;
+    for (int i = 0; i < 8; ++i) {
+        signal(i, text);
+    }
+    CHECK(counter.allocations() == 0);
+    CHECK(waiter.done());
+    CHECK(out.size() == 8);
+}
+
+TEST_CASE("sig11/coro/destroy_while_waiting")
+{
+    sig11::signal<void(int, const std::string&)> signal;
+    std::vector<std::string> out;
+
+    {
+        task waiter(collect(signal, out, 1));
+        CHECK(!waiter.done());
+    }
+
+    signal(1, "a");
+    CHECK(out.empty());
+}
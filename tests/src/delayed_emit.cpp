@@ -0,0 +1,110 @@
+/**********************************************************************
+File name: delayed_emit.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/delayed_emit.hpp"
+#include "sig11/sig11.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+using namespace std::chrono_literals;
+
+
+TEST_CASE("sig11/delayed_emit/emit_after_and_emit_at")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    sig11::timer_wheel wheel(1ms, start);
+    sig11::signal<void(const std::string&, int)> signal;
+    std::vector<std::string> received;
+
+    signal.connect([&received](const std::string &name, int value){
+        received.push_back(name + std::to_string(value));
+    });
+
+    std::string name("retry");
+    sig11::emit_after(wheel, signal, 20ms, name, 2);
+    sig11::emit_at(wheel, signal, start + 10ms, "timeout", 1);
+    name = "changed";
+    CHECK(wheel.payload_arena().blocks_in_use() == 2);
+
+    wheel.advance(start + 15ms);
+    CHECK(received == std::vector<std::string>({"timeout1"}));
+    wheel.advance(start + 20ms);
+    CHECK(received == std::vector<std::string>({"timeout1", "retry2"}));
+    CHECK(wheel.payload_arena().blocks_in_use() == 0);
+}
+
+TEST_CASE("sig11/delayed_emit/cancel_destroys_arguments")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    auto payload = std::make_shared<int>(42);
+    int calls = 0;
+    sig11::signal<void(std::shared_ptr<int>)> signal;
+    signal.connect([&calls](std::shared_ptr<int>){ ++calls; });
+
+    {
+        sig11::timer_wheel wheel(1ms, start);
+        sig11::timer_handle handle = sig11::emit_after(wheel, signal, 10ms, payload);
+        sig11::emit_after(wheel, signal, 1000ms, payload);
+        CHECK(payload.use_count() == 3);
+
+        CHECK(wheel.cancel(handle));
+        CHECK(payload.use_count() == 2);
+        CHECK_FALSE(wheel.cancel(handle));
+
+        wheel.advance(start + 100ms);
+        CHECK(calls == 0);
+    }
+
+    // the wheel discards the emission which was still pending
+    CHECK(payload.use_count() == 1);
+    CHECK(calls == 0);
+}
+
+TEST_CASE("sig11/delayed_emit/receivers_can_reschedule")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    sig11::timer_wheel wheel(1ms, start);
+    sig11::signal<void(int)> retry;
+    std::vector<int> attempts;
+
+    retry.connect([&wheel, &retry, &attempts](int attempt){
+        attempts.push_back(attempt);
+        if (attempt < 3) {
+            sig11::emit_after(wheel, retry, std::chrono::milliseconds(10 << attempt), attempt + 1);
+        }
+    });
+    sig11::emit_after(wheel, retry, 5ms, 0);
+
+    // attempts at 5, 15, 35 and 75ms
+    wheel.advance(start + 35ms);
+    CHECK(attempts == std::vector<int>({0, 1, 2}));
+    wheel.advance(start + 75ms);
+    CHECK(attempts == std::vector<int>({0, 1, 2, 3}));
+    CHECK(wheel.size() == 0);
+}
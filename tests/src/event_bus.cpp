@@ -0,0 +1,112 @@
+/**********************************************************************
+File name: event_bus.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/event_bus.hpp"
+
+#include "alloc_counter.hpp"
+
+#include <string>
+#include <vector>
+
+
+namespace {
+
+struct order_filled
+{
+    int id;
+    double price;
+};
+
+struct order_cancelled
+{
+    int id;
+};
+
+struct heartbeat
+{
+};
+
+using bus_t = sig11::event_bus<order_filled, order_cancelled, heartbeat>;
+
+}
+
+
+TEST_CASE("sig11/event_bus/dispatch_by_type")
+{
+    bus_t bus;
+    std::vector<std::string> received;
+
+    auto filled(bus.subscribe<order_filled>([&received](const order_filled &ev){
+        received.push_back("filled " + std::to_string(ev.id));
+    }));
+    auto cancelled(bus.subscribe<order_cancelled>([&received](const order_cancelled &ev){
+        received.push_back("cancelled " + std::to_string(ev.id));
+    }));
+
+    bus.publish(order_filled{1, 10.5});
+    bus.publish(order_cancelled{2});
+    bus.publish(heartbeat{});
+    CHECK(received == std::vector<std::string>({"filled 1", "cancelled 2"}));
+
+    static_assert(std::is_same<decltype(bus.events<heartbeat>()),
+                               sig11::signal<void(const heartbeat&)>&>::value,
+                  "each event type has its own signal");
+}
+
+TEST_CASE("sig11/event_bus/connect_and_disconnect")
+{
+    bus_t bus;
+    int filled = 0;
+    int beats = 0;
+
+    sig11::connection conn(bus.connect<order_filled>([&filled](const order_filled&){ ++filled; }));
+    auto guard(bus.subscribe<heartbeat>([&beats](const heartbeat&){ ++beats; }));
+
+    bus.publish(order_filled{1, 1.0});
+    bus.publish(heartbeat{});
+    CHECK(filled == 1);
+    CHECK(beats == 1);
+
+    bus.disconnect<order_filled>(conn);
+    guard.disconnect();
+    bus.publish(order_filled{2, 1.0});
+    bus.publish(heartbeat{});
+    CHECK(filled == 1);
+    CHECK(beats == 1);
+}
+
+TEST_CASE("sig11/event_bus/publish_does_not_allocate")
+{
+    bus_t bus;
+    double total = 0;
+    auto guard(bus.subscribe<order_filled>([&total](const order_filled &ev){ total += ev.price; }));
+    bus.publish(order_filled{1, 1.5});
+
+    sig11::alloc_counter counter;
+    bus.publish(order_filled{2, 2.5});
+    bus.publish(order_cancelled{3});
+    CHECK(counter.allocations() == 0);
+    CHECK(total == 4.0);
+}
@@ -0,0 +1,143 @@
+/**********************************************************************
+File name: event_loop.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/event_loop.hpp"
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+
+static bool is_readable(int fd)
+{
+    const int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    REQUIRE(epoll_fd >= 0);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    REQUIRE(::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0);
+    const bool result = ::epoll_wait(epoll_fd, &event, 1, 0) == 1;
+    ::close(epoll_fd);
+    return result;
+}
+
+
+TEST_CASE("sig11/wakeup_fd/coalesces_notifications")
+{
+    sig11::wakeup_fd wakeup;
+    CHECK(!is_readable(wakeup.fd()));
+
+    for (int i = 0; i < 10; ++i) {
+        wakeup.notify();
+    }
+    CHECK(is_readable(wakeup.fd()));
+
+    // a single write for all notifications
+    std::uint64_t value = 0;
+    REQUIRE(::read(wakeup.fd(), &value, sizeof(value)) == sizeof(value));
+    CHECK(value == 1);
+
+    wakeup.consume();
+    CHECK(!is_readable(wakeup.fd()));
+
+    wakeup.notify();
+    CHECK(is_readable(wakeup.fd()));
+}
+
+TEST_CASE("sig11/event_loop_bridge/dispatch_in_batch")
+{
+    sig11::signal<void(int, const std::string&)> source;
+    sig11::event_loop_bridge<int, std::string> bridge(16);
+    auto guard(sig11::connect(source, bridge));
+
+    std::vector<std::string> received;
+    bridge.target().connect([&received](int number, const std::string &text){
+        received.push_back(std::to_string(number) + text);
+    });
+
+    CHECK(!is_readable(bridge.fd()));
+    source(1, "a");
+    source(2, "b");
+    source(3, "c");
+    CHECK(received.empty());
+    CHECK(is_readable(bridge.fd()));
+
+    CHECK(bridge.dispatch() == 3);
+    CHECK(received == std::vector<std::string>({"1a", "2b", "3c"}));
+    CHECK(!is_readable(bridge.fd()));
+
+    CHECK(bridge.dispatch() == 0);
+}
+
+TEST_CASE("sig11/event_loop_bridge/cross_thread")
+{
+    static const int emits = 10000;
+
+    sig11::signal<void(int)> source;
+    sig11::event_loop_bridge<int> bridge(64);
+    auto guard(sig11::connect(source, bridge));
+
+    const std::thread::id loop_thread = std::this_thread::get_id();
+    bool on_loop_thread = true;
+    std::vector<int> received;
+    bridge.target().connect([&](int value){
+        on_loop_thread = on_loop_thread && std::this_thread::get_id() == loop_thread;
+        received.push_back(value);
+    });
+
+    const int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    REQUIRE(epoll_fd >= 0);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    REQUIRE(::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, bridge.fd(), &event) == 0);
+
+    std::thread emitter([&source](){
+        for (int i = 0; i < emits; ++i) {
+            source(i);
+        }
+    });
+
+    int wakeups = 0;
+    while (received.size() < static_cast<std::size_t>(emits)) {
+        if (::epoll_wait(epoll_fd, &event, 1, 1000) == 1) {
+            ++wakeups;
+            bridge.dispatch();
+        }
+    }
+    emitter.join();
+    ::close(epoll_fd);
+
+    bool in_order = true;
+    for (int i = 0; i < emits; ++i) {
+        in_order = in_order && received[i] == i;
+    }
+    CHECK(in_order);
+    CHECK(on_loop_thread);
+    CHECK(wakeups <= emits);
+    CHECK(bridge.queue().dropped() == 0);
+}
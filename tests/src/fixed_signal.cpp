@@ -0,0 +1,170 @@
+/**********************************************************************
+File name: fixed_signal.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/fixed_signal.hpp"
+
+#include "alloc_counter.hpp"
+
+#include <string>
+#include <vector>
+
+
+TEST_CASE("sig11/fixed_signal/connect_emit_disconnect")
+{
+    sig11::fixed_signal<4, void(int)> signal;
+    std::vector<std::pair<int, int> > values;
+
+    auto fun1 = [&values](int value){ values.emplace_back(0, value); };
+    auto fun2 = [&values](int value){ values.emplace_back(1, value); };
+    auto fun3 = [&values](int value){ values.emplace_back(2, value); };
+
+    signal.connect(fun1);
+    sig11::connection conn(signal.connect(fun2));
+    signal.connect(fun3);
+    CHECK(conn);
+    signal(10);
+    signal.disconnect(conn);
+    CHECK_FALSE(conn);
+    signal(20);
+
+    std::vector<std::pair<int, int> > reference({{0, 10}, {1, 10}, {2, 10}, {0, 20}, {2, 20}});
+    CHECK(values == reference);
+}
+
+TEST_CASE("sig11/fixed_signal/connect_reports_full")
+{
+    sig11::fixed_signal<2, void(int)> signal;
+    int destination = 0;
+    auto fun = [&destination](int value){ destination += value; };
+
+    CHECK(signal.capacity() == 2);
+    CHECK_FALSE(signal.full());
+    sig11::connection conn1(signal.connect(fun));
+    sig11::connection conn2(signal.connect(fun));
+    CHECK(signal.full());
+
+    sig11::connection conn3(signal.connect(fun));
+    CHECK_FALSE(conn3);
+
+    signal(1);
+    CHECK(destination == 2);
+
+    signal.disconnect(conn1);
+    CHECK_FALSE(signal.full());
+    conn3 = signal.connect(fun);
+    CHECK(conn3);
+    CHECK(conn3.id() != conn2.id());
+}
+
+TEST_CASE("sig11/fixed_signal/disconnect_during_emit")
+{
+    sig11::fixed_signal<2, void(int), 3*sizeof(void*)> signal;
+    sig11::connection conn;
+    int destination = 0;
+
+    auto fun = [&destination, &conn, &signal](int value){ destination = value; signal.disconnect(conn); };
+
+    conn = signal.connect(fun);
+    signal(10);
+    CHECK(destination == 10);
+    CHECK_FALSE(conn);
+    signal(20);
+    CHECK(destination == 10);
+}
+
+TEST_CASE("sig11/fixed_signal/connect_guard")
+{
+    sig11::fixed_signal<1, void(int)> signal;
+    int destination = 0;
+    auto fun = [&destination](int value){ destination = value; };
+
+    {
+        auto guard(sig11::connect(signal, fun));
+        CHECK(guard);
+        auto second_guard(sig11::connect(signal, fun));
+        CHECK_FALSE(second_guard);
+        signal(10);
+        CHECK(destination == 10);
+    }
+
+    CHECK_FALSE(signal.full());
+    signal(20);
+    CHECK(destination == 10);
+}
+
+TEST_CASE("sig11/fixed_signal/no_allocations")
+{
+    sig11::fixed_signal<8, void(int)> signal;
+    int destination = 0;
+    auto fun = [&destination](int value){ destination += value; };
+
+    sig11::alloc_counter counter;
+
+    sig11::connection conns[8];
+    for (auto &conn: conns) {
+        conn = signal.connect(fun);
+    }
+    CHECK_FALSE(signal.connect(fun));
+
+    signal(1);
+    CHECK(destination == 8);
+
+    for (auto &conn: conns) {
+        signal.disconnect(conn);
+    }
+    signal(1);
+    CHECK(destination == 8);
+
+    {
+        auto guard(sig11::connect(signal, fun));
+        signal(1);
+    }
+    CHECK(destination == 9);
+
+    CHECK(counter.allocations() == 0);
+}
+
+TEST_CASE("sig11/fixed_signal/arguments_not_copied")
+{
+    sig11::fixed_signal<2, void(std::string)> signal;
+    const std::string value(64, 'x');
+    std::size_t length = 0;
+    auto fun = [&length](const std::string &value){ length += value.size(); };
+    signal.connect(fun);
+    signal.connect(fun);
+
+    sig11::alloc_counter counter;
+    signal(value);
+    CHECK(counter.allocations() == 0);
+    CHECK(length == 2 * value.size());
+}
+
+TEST_CASE("sig11/alloc_counter/counts_allocations")
+{
+    sig11::alloc_counter counter;
+    std::vector<int> values;
+    values.push_back(1);
+    CHECK(counter.allocations() == 1);
+}
@@ -0,0 +1,181 @@
+/**********************************************************************
+File name: histogram.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/sig11.hpp"
+#include "sig11/histogram.hpp"
+
+#include "alloc_counter.hpp"
+
+#include <chrono>
+#include <map>
+#include <stdexcept>
+#include <thread>
+
+
+using namespace std::chrono;
+
+
+TEST_CASE("sig11/latency_histogram/bucket_mapping")
+{
+    using hist = sig11::latency_histogram;
+
+    for (std::uint64_t ns = 0; ns < hist::sub_buckets; ++ns) {
+        CHECK(hist::bucket_index(ns) == ns);
+        CHECK(hist::bucket_upper_bound(ns) == ns);
+    }
+
+    for (std::uint64_t ns: {16ull, 17ull, 100ull, 1000ull, 123456ull, 1000000007ull}) {
+        const std::size_t index = hist::bucket_index(ns);
+        const std::uint64_t upper = hist::bucket_upper_bound(index);
+        CHECK(upper >= ns);
+        CHECK(upper - ns <= ns / hist::sub_buckets);
+        CHECK(hist::bucket_index(upper) == index);
+        CHECK(hist::bucket_index(upper + 1) == index + 1);
+    }
+
+    CHECK(hist::bucket_index(hist::max_trackable) == hist::bucket_count - 1);
+    CHECK(hist::bucket_index(~std::uint64_t(0)) == hist::bucket_count - 1);
+}
+
+TEST_CASE("sig11/latency_histogram/statistics")
+{
+    sig11::latency_histogram hist;
+    CHECK(hist.count() == 0);
+    CHECK(hist.percentile(50) == nanoseconds(0));
+    CHECK(hist.mean() == nanoseconds(0));
+
+    for (int i = 1; i <= 100; ++i) {
+        hist.record(microseconds(i));
+    }
+
+    CHECK(hist.count() == 100);
+    CHECK(hist.max() == microseconds(100));
+    CHECK(hist.total() == microseconds(5050));
+    CHECK(hist.mean() == nanoseconds(50500));
+
+    const nanoseconds p50 = hist.percentile(50);
+    CHECK(p50 >= microseconds(50));
+    CHECK(p50 <= microseconds(50) + microseconds(50) / 16);
+
+    const nanoseconds p99 = hist.percentile(99);
+    CHECK(p99 >= microseconds(99));
+    CHECK(p99 <= microseconds(100));
+
+    CHECK(hist.percentile(100) == microseconds(100));
+
+    hist.reset();
+    CHECK(hist.count() == 0);
+    CHECK(hist.max() == nanoseconds(0));
+}
+
+TEST_CASE("sig11/slot_latency_tracer/per_slot_histograms")
+{
+    sig11::signal<void(int), sig11::slot_latency_tracer> signal;
+
+    sig11::connection fast(signal.connect([](int){}));
+    sig11::connection slow(signal.connect([](int){ std::this_thread::sleep_for(milliseconds(2)); }));
+
+    for (int i = 0; i < 5; ++i) {
+        signal(i);
+    }
+
+    nanoseconds fast_p50(0);
+    nanoseconds slow_p50(0);
+    CHECK(signal.visit_slot_state(fast, [&fast_p50](const sig11::latency_histogram &hist){
+        CHECK(hist.count() == 5);
+        fast_p50 = hist.percentile(50);
+    }));
+    CHECK(signal.visit_slot_state(slow, [&slow_p50](const sig11::latency_histogram &hist){
+        CHECK(hist.count() == 5);
+        slow_p50 = hist.percentile(50);
+    }));
+    CHECK(slow_p50 >= milliseconds(2));
+    CHECK(fast_p50 < slow_p50);
+
+    std::map<sig11::token_id, std::uint64_t> counts;
+    signal.visit_slot_states([&counts](sig11::token_id id, const sig11::latency_histogram &hist){
+        counts[id] = hist.count();
+    });
+    std::map<sig11::token_id, std::uint64_t> reference({{fast.id(), 5}, {slow.id(), 5}});
+    CHECK(counts == reference);
+
+    const sig11::token_id slow_id = slow.id();
+    signal.disconnect(slow);
+    CHECK_FALSE(signal.visit_slot_state(slow, [](const sig11::latency_histogram&){}));
+    counts.clear();
+    signal.visit_slot_states([&counts](sig11::token_id id, const sig11::latency_histogram &hist){
+        counts[id] = hist.count();
+    });
+    CHECK(counts.count(slow_id) == 0);
+    CHECK(counts.size() == 1);
+}
+
+TEST_CASE("sig11/slot_latency_tracer/nested_emit_does_not_allocate")
+{
+    sig11::signal<void(int), sig11::slot_latency_tracer> signal;
+    sig11::connection conn(signal.connect([&signal](int depth){
+        if (depth > 0) {
+            signal(depth - 1);
+        }
+    }));
+
+    // the first emission sets up the dispatch buffers of each depth
+    signal(4);
+
+    std::size_t allocations;
+    {
+        sig11::alloc_counter counter;
+        signal(4);
+        allocations = counter.allocations();
+    }
+    CHECK(allocations == 0);
+
+    CHECK(signal.visit_slot_state(conn, [](const sig11::latency_histogram &hist){
+        CHECK(hist.count() == 10);
+    }));
+}
+
+TEST_CASE("sig11/slot_latency_tracer/recovers_from_throwing_receivers")
+{
+    sig11::signal<void(int), sig11::slot_latency_tracer> signal;
+    sig11::connection conn(signal.connect([&signal](int depth){
+        if (depth < 0) {
+            throw std::runtime_error("failed");
+        }
+        if (depth > 0) {
+            signal(depth - 1);
+        }
+    }));
+
+    // each throw leaves a start time behind
+    for (int i = 0; i < 40; ++i) {
+        CHECK_THROWS_AS(signal(-1), std::runtime_error);
+    }
+    signal(3);
+
+    CHECK(signal.visit_slot_state(conn, [](const sig11::latency_histogram &hist){
+        CHECK(hist.count() == 4);
+    }));
+}
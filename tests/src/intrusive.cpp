@@ -0,0 +1,342 @@
+/**********************************************************************
+File name: intrusive.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/intrusive.hpp"
+
+#include "alloc_counter.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+class Receiver
+{
+public:
+    Receiver(std::vector<std::pair<int, int> > &log, int id):
+        m_log(log),
+        m_id(id),
+        hook([this](int value){ on_value(value); })
+    {
+
+    }
+
+private:
+    std::vector<std::pair<int, int> > &m_log;
+    int m_id;
+
+    void on_value(int value)
+    {
+        m_log.emplace_back(m_id, value);
+    }
+
+public:
+    sig11::slot<void(int)> hook;
+
+};
+
+
+TEST_CASE("sig11/intrusive_signal/connect_and_emit")
+{
+    sig11::intrusive_signal<void(int)> signal;
+    std::vector<std::pair<int, int> > log;
+    Receiver r1(log, 1);
+    Receiver r2(log, 2);
+
+    CHECK_FALSE(r1.hook);
+    sig11::connect(signal, r1.hook);
+    signal.connect(r2.hook);
+    CHECK(r1.hook);
+    CHECK(r2.hook);
+
+    signal(10);
+    r1.hook.disconnect();
+    CHECK_FALSE(r1.hook);
+    signal(20);
+
+    std::vector<std::pair<int, int> > reference({{1, 10}, {2, 10}, {2, 20}});
+    CHECK(log == reference);
+}
+
+TEST_CASE("sig11/intrusive_signal/receiver_destruction_disconnects")
+{
+    sig11::intrusive_signal<void(int)> signal;
+    std::vector<std::pair<int, int> > log;
+    std::unique_ptr<Receiver> r1(new Receiver(log, 1));
+    Receiver r2(log, 2);
+    std::unique_ptr<Receiver> r3(new Receiver(log, 3));
+
+    signal.connect(r1->hook);
+    signal.connect(r2.hook);
+    signal.connect(r3->hook);
+    signal(10);
+    r1.reset();
+    signal(20);
+    r3.reset();
+    signal(30);
+
+    std::vector<std::pair<int, int> > reference({{1, 10}, {2, 10}, {3, 10}, {2, 20}, {3, 20}, {2, 30}});
+    CHECK(log == reference);
+}
+
+TEST_CASE("sig11/intrusive_signal/signal_destruction_disconnects")
+{
+    std::vector<std::pair<int, int> > log;
+    Receiver r1(log, 1);
+
+    {
+        sig11::intrusive_signal<void(int)> signal;
+        signal.connect(r1.hook);
+        CHECK(r1.hook);
+    }
+
+    CHECK_FALSE(r1.hook);
+}
+
+TEST_CASE("sig11/intrusive_signal/reconnect_moves_slot")
+{
+    sig11::intrusive_signal<void(int)> signal1;
+    sig11::intrusive_signal<void(int)> signal2;
+    std::vector<std::pair<int, int> > log;
+    Receiver r1(log, 1);
+
+    signal1.connect(r1.hook);
+    signal1.connect(r1.hook);
+    signal1(10);
+    signal2.connect(r1.hook);
+    signal1(20);
+    signal2(30);
+
+    std::vector<std::pair<int, int> > reference({{1, 10}, {1, 30}});
+    CHECK(log == reference);
+}
+
+TEST_CASE("sig11/intrusive_signal/disconnect_during_emit")
+{
+    sig11::intrusive_signal<void(int)> signal;
+    std::vector<int> log;
+
+    sig11::slot<void(int)> *other = nullptr;
+    sig11::slot<void(int)> self_disconnect([&log, &other](int value){ log.push_back(value); other->disconnect(); });
+    sig11::slot<void(int)> victim([&log](int value){ log.push_back(-value); });
+    other = &victim;
+
+    signal.connect(self_disconnect);
+    signal.connect(victim);
+    signal(10);
+    signal(20);
+
+    std::vector<int> reference({10, 20});
+    CHECK(log == reference);
+}
+
+TEST_CASE("sig11/intrusive_signal/connect_during_emit")
+{
+    sig11::intrusive_signal<void(int)> signal;
+    std::vector<int> log;
+
+    sig11::slot<void(int)> late([&log](int value){ log.push_back(-value); });
+    sig11::slot<void(int)> connector([&signal, &late](int){ signal.connect(late); });
+
+    signal.connect(connector);
+    signal(10);
+    signal(20);
+
+    std::vector<int> reference({-20});
+    CHECK(log == reference);
+}
+
+TEST_CASE("sig11/intrusive_signal/reentrant_emit")
+{
+    sig11::intrusive_signal<void(int)> signal;
+    std::vector<int> log;
+
+    sig11::slot<void(int)> recurse([&signal](int value){ if (value > 0) { signal(value - 1); } });
+    sig11::slot<void(int)> record([&log](int value){ log.push_back(value); });
+
+    signal.connect(recurse);
+    signal.connect(record);
+    signal(2);
+
+    std::vector<int> reference({0, 1, 2});
+    CHECK(log == reference);
+}
+
+TEST_CASE("sig11/intrusive_signal/disconnect_across_batches")
+{
+    static const int slots = 3 * sig11::intrusive_signal<void(int)>::batch_size;
+
+    struct state
+    {
+        std::vector<int> log;
+        std::vector<std::unique_ptr<sig11::slot<void(int)> > > hooks;
+    };
+
+    sig11::intrusive_signal<void(int)> signal;
+    state st;
+
+    for (int i = 0; i < slots; ++i) {
+        st.hooks.emplace_back(new sig11::slot<void(int)>([&st, i](int){
+            st.log.push_back(i);
+            // disconnect one slot of the current batch and one of the next
+            if (i % 4 == 0 && i + 20 < slots) {
+                st.hooks[i + 1]->disconnect();
+                st.hooks[i + 20]->disconnect();
+            }
+        }));
+        signal.connect(*st.hooks.back());
+    }
+
+    signal(0);
+
+    std::vector<int> reference;
+    std::vector<bool> gone(slots, false);
+    for (int i = 0; i < slots; ++i) {
+        if (gone[i]) {
+            continue;
+        }
+        reference.push_back(i);
+        if (i % 4 == 0 && i + 20 < slots) {
+            gone[i + 1] = true;
+            gone[i + 20] = true;
+        }
+    }
+    CHECK(st.log == reference);
+}
+
+TEST_CASE("sig11/intrusive_signal/no_allocations")
+{
+    sig11::intrusive_signal<void(std::string)> signal;
+    const std::string value(64, 'x');
+    std::size_t length = 0;
+
+    std::size_t allocations;
+    {
+        sig11::alloc_counter counter;
+        sig11::slot<void(std::string)> hook([&length](const std::string &value){
+            length += value.size();
+        });
+        signal.connect(hook);
+        // the argument is passed on by reference, never copied
+        signal(value);
+        hook.disconnect();
+        signal(value);
+        signal.connect(hook);
+        allocations = counter.allocations();
+    }
+
+    CHECK(length == value.size());
+    CHECK(allocations == 0);
+}
+
+TEST_CASE("sig11/intrusive_signal/destruction_waits_for_invocation")
+{
+    sig11::intrusive_signal<void(int)> signal;
+    std::atomic<bool> entered(false);
+    std::atomic<bool> finished(false);
+
+    struct Receiver
+    {
+        explicit Receiver(std::atomic<bool> &entered, std::atomic<bool> &finished):
+            entered(entered),
+            finished(finished),
+            hook([this](int){ on_value(); })
+        {
+
+        }
+
+        std::atomic<bool> &entered;
+        std::atomic<bool> &finished;
+        sig11::slot<void(int)> hook;
+
+        void on_value()
+        {
+            entered = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            finished = true;
+        }
+    };
+
+    std::unique_ptr<Receiver> receiver(new Receiver(entered, finished));
+    signal.connect(receiver->hook);
+
+    std::thread emitter([&signal](){ signal(1); });
+    while (!entered.load()) {
+        std::this_thread::yield();
+    }
+    receiver.reset();
+    CHECK(finished.load());
+    emitter.join();
+}
+
+TEST_CASE("sig11/intrusive_signal/disconnect_does_not_wait_for_batch")
+{
+    struct State
+    {
+        std::atomic<bool> first_entered{false};
+        std::atomic<bool> first_finished{false};
+        std::atomic<bool> disconnected{false};
+        bool timed_out = false;
+    };
+
+    State state;
+    State *state_ptr = &state;
+    sig11::intrusive_signal<void(int)> signal;
+
+    sig11::slot<void(int)> first([state_ptr](int){
+        state_ptr->first_entered = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        state_ptr->first_finished = true;
+    });
+    // runs in the same batch as first; it blocks the batch until the
+    // disconnect of first has returned
+    sig11::slot<void(int)> second([state_ptr](int){
+        const auto deadline = std::chrono::steady_clock::now() +
+                std::chrono::seconds(2);
+        while (!state_ptr->disconnected.load()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                state_ptr->timed_out = true;
+                return;
+            }
+            std::this_thread::yield();
+        }
+    });
+    signal.connect(first);
+    signal.connect(second);
+
+    std::thread emitter([&signal](){ signal(1); });
+    while (!state.first_entered.load()) {
+        std::this_thread::yield();
+    }
+    first.disconnect();
+    CHECK(state.first_finished.load());
+    state.disconnected = true;
+    emitter.join();
+
+    CHECK_FALSE(state.timed_out);
+}
@@ -0,0 +1,212 @@
+/**********************************************************************
+File name: lock_policy.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/sig11.hpp"
+#include "sig11/lock_policy.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+template <typename mutex_t>
+static void check_signal_with_policy()
+{
+    using signal_t = sig11::signal<void(int), sig11::null_tracer, mutex_t>;
+    signal_t signal;
+    std::vector<int> received;
+
+    {
+        sig11::connection_guard<void(int)> guard(
+                    sig11::connect(signal, [&received](int value){ received.push_back(value); }));
+        signal(1);
+        CHECK(guard);
+    }
+    signal(2);
+
+    sig11::connection conn(signal.connect([&received](int value){ received.push_back(value * 10); }));
+    signal(3);
+    signal.disconnect(conn);
+    signal(4);
+
+    CHECK(received == std::vector<int>({1, 30}));
+    CHECK(!conn);
+}
+
+
+TEST_CASE("sig11/lock_policy/null_mutex")
+{
+    check_signal_with_policy<sig11::null_mutex>();
+}
+
+TEST_CASE("sig11/lock_policy/std_mutex")
+{
+    check_signal_with_policy<std::mutex>();
+}
+
+TEST_CASE("sig11/lock_policy/spin_mutex")
+{
+    check_signal_with_policy<sig11::spin_mutex>();
+}
+
+TEST_CASE("sig11/lock_policy/shared_mutex")
+{
+    check_signal_with_policy<sig11::shared_mutex>();
+}
+
+TEST_CASE("sig11/lock_policy/has_lock_shared")
+{
+    CHECK(sig11::detail::has_lock_shared<sig11::shared_mutex>::value);
+    CHECK(!sig11::detail::has_lock_shared<std::mutex>::value);
+    CHECK(!sig11::detail::has_lock_shared<sig11::spin_mutex>::value);
+    CHECK(!sig11::detail::has_lock_shared<sig11::null_mutex>::value);
+}
+
+TEST_CASE("sig11/lock_policy/spin_mutex/mutual_exclusion")
+{
+    static const int threads = 4;
+    static const int iterations = 20000;
+
+    sig11::spin_mutex mutex;
+    int counter = 0;
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&mutex, &counter](){
+            for (int j = 0; j < iterations; ++j) {
+                std::lock_guard<sig11::spin_mutex> lock(mutex);
+                ++counter;
+            }
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+
+    CHECK(counter == threads * iterations);
+
+    CHECK(mutex.try_lock());
+    CHECK(!mutex.try_lock());
+    mutex.unlock();
+}
+
+TEST_CASE("sig11/lock_policy/shared_mutex/disconnect_during_concurrent_emit")
+{
+    static const int iterations = 2000;
+
+    sig11::signal<void(int), sig11::null_tracer, sig11::shared_mutex> signal;
+    std::atomic<bool> stop(false);
+    std::atomic<int> calls(0);
+
+    auto guard(sig11::connect(signal, [&calls](int){ calls.fetch_add(1); }));
+
+    std::thread writer([&signal, &stop, &calls](){
+        while (!stop.load()) {
+            sig11::connection conn(signal.connect([&calls](int){ calls.fetch_add(1); }));
+            signal.disconnect(conn);
+        }
+    });
+
+    for (int i = 0; i < iterations; ++i) {
+        signal(i);
+    }
+    stop = true;
+    writer.join();
+
+    CHECK(calls.load() >= iterations);
+
+    int remaining = 0;
+    signal.visit_slot_states([&remaining](sig11::token_id, sig11::null_tracer::slot_state&){
+        ++remaining;
+    });
+    CHECK(remaining == 1);
+}
+
+namespace {
+
+/**
+ * Shared mutex which counts how often it is taken in exclusive mode.
+ */
+class counting_mutex
+{
+public:
+    void lock()
+    {
+        m_mutex.lock();
+        ++exclusive_locks;
+    }
+
+    void unlock()
+    {
+        m_mutex.unlock();
+    }
+
+    void lock_shared()
+    {
+        m_mutex.lock_shared();
+    }
+
+    void unlock_shared()
+    {
+        m_mutex.unlock_shared();
+    }
+
+    static int exclusive_locks;
+
+private:
+    sig11::shared_mutex m_mutex;
+};
+
+int counting_mutex::exclusive_locks = 0;
+
+}
+
+TEST_CASE("sig11/lock_policy/connect_once_emit_stays_shared")
+{
+    using signal_t = sig11::signal<void(), sig11::null_tracer, counting_mutex>;
+    signal_t signal;
+    std::shared_ptr<int> calls = std::make_shared<int>(0);
+
+    // fewer one-shots than needed for a compaction
+    for (std::size_t i = 0; i < signal_t::compact_min_tombstones - 1; ++i) {
+        signal.connect_once([calls](){ ++*calls; });
+    }
+    auto guard(sig11::connect(signal, [calls](){ ++*calls; }));
+    const int locked = counting_mutex::exclusive_locks;
+
+    signal();
+    signal();
+    CHECK(*calls == static_cast<int>(signal_t::compact_min_tombstones) + 1);
+    CHECK(counting_mutex::exclusive_locks == locked);
+    // the receivers are gone even though their tombstones are not
+    CHECK(calls.use_count() == 2);
+
+    int remaining = 0;
+    signal.visit_slot_states([&remaining](sig11::token_id, sig11::null_tracer::slot_state&){
+        ++remaining;
+    });
+    CHECK(remaining == 1);
+}
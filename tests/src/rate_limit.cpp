@@ -0,0 +1,221 @@
+/**********************************************************************
+File name: rate_limit.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/rate_limit.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+using namespace std::chrono_literals;
+
+
+TEST_CASE("sig11/rate_limit/throttle")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    sig11::timer_wheel wheel(1ms, start);
+    sig11::signal<void(int)> signal;
+    std::vector<int> received;
+
+    auto guard(sig11::connect_rate_limited(
+                   signal, wheel, sig11::throttle(10ms),
+                   [&received](int value){ received.push_back(value); }));
+
+    // leading edge
+    signal(1);
+    signal(2);
+    signal(3);
+    CHECK(received == std::vector<int>({1}));
+
+    // trailing edge with the latest value, which opens the next window
+    wheel.advance(start + 10ms);
+    CHECK(received == std::vector<int>({1, 3}));
+    signal(4);
+    wheel.advance(start + 15ms);
+    CHECK(received == std::vector<int>({1, 3}));
+    wheel.advance(start + 20ms);
+    CHECK(received == std::vector<int>({1, 3, 4}));
+
+    // the window closes without emissions, so the next one leads again
+    wheel.advance(start + 30ms);
+    signal(5);
+    CHECK(received == std::vector<int>({1, 3, 4, 5}));
+}
+
+TEST_CASE("sig11/rate_limit/throttle_leading_only")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    sig11::timer_wheel wheel(1ms, start);
+    sig11::signal<void(int)> signal;
+    std::vector<int> received;
+
+    auto guard(sig11::connect_rate_limited(
+                   signal, wheel, sig11::max_rate(1, 10ms),
+                   [&received](int value){ received.push_back(value); }));
+    CHECK(sig11::max_rate(100, 1s).interval == 10ms);
+
+    auto guard2(sig11::connect_rate_limited(
+                    signal, wheel, sig11::throttle(10ms, sig11::rate_limit_edge::leading),
+                    [&received](int value){ received.push_back(-value); }));
+
+    for (int i = 0; i < 100; ++i) {
+        signal(i);
+        wheel.advance(start + std::chrono::milliseconds(i));
+    }
+    // both pass on at most one call per 10ms; the first one also the last
+    // value of each window
+    int positive = 0;
+    int negative = 0;
+    for (int value: received) {
+        if (value > 0) {
+            ++positive;
+        } else if (value < 0) {
+            ++negative;
+        }
+    }
+    CHECK(positive <= 10);
+    CHECK(negative == 9);
+}
+
+TEST_CASE("sig11/rate_limit/max_rate_rejects_zero_count")
+{
+    CHECK_THROWS_AS(sig11::max_rate(0, 1s), std::invalid_argument);
+    CHECK(sig11::max_rate(1, 1s).interval == 1s);
+}
+
+TEST_CASE("sig11/rate_limit/debounce")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    sig11::timer_wheel wheel(1ms, start);
+    sig11::signal<void(int)> signal;
+    std::vector<int> received;
+
+    auto guard(sig11::connect_rate_limited(
+                   signal, wheel, sig11::debounce(10ms),
+                   [&received](int value){ received.push_back(value); }));
+
+    // a burst with gaps shorter than the interval
+    for (int i = 1; i <= 5; ++i) {
+        signal(i);
+        wheel.advance(start + std::chrono::milliseconds(5 * i));
+    }
+    CHECK(received.empty());
+
+    // last emission at 20ms; the pause ends at 30ms
+    wheel.advance(start + 29ms);
+    CHECK(received.empty());
+    wheel.advance(start + 30ms);
+    CHECK(received == std::vector<int>({5}));
+    CHECK(wheel.size() == 0);
+}
+
+TEST_CASE("sig11/rate_limit/debounce_leading")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    sig11::timer_wheel wheel(1ms, start);
+    sig11::signal<void(int)> signal;
+    std::vector<int> received;
+
+    auto guard(sig11::connect_rate_limited(
+                   signal, wheel, sig11::debounce(10ms, sig11::rate_limit_edge::leading),
+                   [&received](int value){ received.push_back(value); }));
+
+    signal(1);
+    wheel.advance(start + 5ms);
+    signal(2);
+    wheel.advance(start + 14ms);
+    signal(3);
+    CHECK(received == std::vector<int>({1}));
+
+    wheel.advance(start + 30ms);
+    signal(4);
+    CHECK(received == std::vector<int>({1, 4}));
+}
+
+TEST_CASE("sig11/rate_limit/disconnect_cancels_timer")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    sig11::timer_wheel wheel(1ms, start);
+    sig11::signal<void(int)> signal;
+    std::vector<int> received;
+
+    auto guard(sig11::connect_rate_limited(
+                   signal, wheel, sig11::throttle(10ms),
+                   [&received](int value){ received.push_back(value); }));
+    signal(1);
+    signal(2);
+    CHECK(wheel.size() == 1);
+
+    guard.disconnect();
+    CHECK(wheel.size() == 0);
+    wheel.advance(start + 100ms);
+    CHECK(received == std::vector<int>({1}));
+}
+
+TEST_CASE("sig11/rate_limit/disconnect_waits_for_trailing_call")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    sig11::timer_wheel wheel(1ms, start);
+    sig11::signal<void(int)> signal;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool entered = false;
+    std::atomic<bool> finished(false);
+
+    auto guard(sig11::connect_rate_limited(
+                   signal, wheel, sig11::throttle(10ms),
+                   [&](int value){
+                       if (value != 2) {
+                           return;
+                       }
+                       {
+                           std::lock_guard<std::mutex> lock(mutex);
+                           entered = true;
+                       }
+                       cv.notify_all();
+                       std::this_thread::sleep_for(50ms);
+                       finished = true;
+                   }));
+    signal(1);
+    signal(2);
+
+    // the trailing call opens the next window before calling the receiver
+    std::thread driver([&wheel, start](){ wheel.advance(start + 10ms); });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&entered](){ return entered; });
+    }
+    guard.disconnect();
+    CHECK(finished);
+
+    driver.join();
+    CHECK(wheel.size() == 0);
+}
@@ -0,0 +1,159 @@
+/**********************************************************************
+File name: recorder.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/recorder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+
+struct tick
+{
+    int id;
+    double price;
+};
+
+
+static std::string log_path(const char *suffix)
+{
+    return "/tmp/sig11-test-" + std::to_string(::getpid()) + "-" + suffix + ".log";
+}
+
+
+TEST_CASE("sig11/recorder/record_and_replay")
+{
+    const std::string path(log_path("basic"));
+    {
+        sig11::signal<void(int, tick)> signal;
+        sig11::emission_recorder<void(int, tick)> recorder(path, 2);
+        auto guard(sig11::connect(signal, recorder));
+
+        // grows past the initial capacity
+        for (int i = 0; i < 10; ++i) {
+            signal(i, tick{i * 10, i * 0.5});
+        }
+        CHECK(recorder.size() == 10);
+    }
+
+    sig11::emission_log<void(int, tick)> log(path);
+    REQUIRE(log.size() == 10);
+    for (std::size_t i = 1; i < log.size(); ++i) {
+        CHECK(log.timestamp(i) >= log.timestamp(i - 1));
+    }
+
+    sig11::signal<void(int, tick)> target;
+    std::vector<int> received;
+    target.connect([&received](int seq, tick t){
+        received.push_back(seq * 1000 + t.id);
+        CHECK(t.price == seq * 0.5);
+    });
+    CHECK(log.replay(target, sig11::replay_speed::maximum) == 10);
+    CHECK(received == std::vector<int>({0, 1010, 2020, 3030, 4040, 5050, 6060, 7070, 8080, 9090}));
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("sig11/recorder/replay_keeps_original_spacing")
+{
+    const std::string path(log_path("spacing"));
+    {
+        sig11::emission_recorder<void(int)> recorder(path);
+        recorder(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        recorder(2);
+    }
+
+    sig11::emission_log<void(int)> log(path);
+    REQUIRE(log.size() == 2);
+    CHECK(log.timestamp(1) - log.timestamp(0) >= std::chrono::milliseconds(20));
+
+    sig11::signal<void(int)> target;
+    std::vector<std::chrono::steady_clock::time_point> times;
+    target.connect([&times](int){ times.push_back(std::chrono::steady_clock::now()); });
+
+    // a late wakeup for the first record must not count against the second
+    const auto before = std::chrono::steady_clock::now();
+    log.replay(target);
+    REQUIRE(times.size() == 2);
+    CHECK(times[1] - before >= log.timestamp(1));
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("sig11/recorder/mismatched_log_is_rejected")
+{
+    const std::string path(log_path("mismatch"));
+    {
+        sig11::emission_recorder<void(int)> recorder(path);
+        recorder(1);
+    }
+
+    CHECK_THROWS_AS(sig11::emission_log<void(int, tick)>(path), std::runtime_error);
+    CHECK_NOTHROW(sig11::emission_log<void(int)>(path));
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("sig11/recorder/concurrent_appends_grow")
+{
+    static const int threads = 4;
+    static const int appends = 2000;
+
+    const std::string path(log_path("concurrent"));
+    {
+        sig11::emission_recorder<void(int)> recorder(path, 1);
+
+        std::vector<std::thread> workers;
+        for (int i = 0; i < threads; ++i) {
+            workers.emplace_back([&recorder, i](){
+                for (int j = 0; j < appends; ++j) {
+                    recorder(i * appends + j);
+                }
+            });
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+        CHECK(recorder.size() == threads * appends);
+    }
+
+    sig11::emission_log<void(int)> log(path);
+    REQUIRE(log.size() == threads * appends);
+
+    std::vector<int> seen(threads * appends, 0);
+    sig11::signal<void(int)> target;
+    target.connect([&seen](int value){ ++seen[value]; });
+    log.replay(target, sig11::replay_speed::maximum);
+    CHECK(std::count(seen.begin(), seen.end(), 1) == threads * appends);
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,227 @@
+/**********************************************************************
+File name: registry.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/sig11.hpp"
+#include "sig11/registry.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+
+using signal_t = sig11::signal<void(int), sig11::metrics_tracer>;
+
+
+TEST_CASE("sig11/signal_registry/registration")
+{
+    sig11::signal_registry registry;
+    CHECK(registry.snapshot().empty());
+
+    {
+        signal_t signal1("first", registry);
+        std::unique_ptr<signal_t> signal2(new signal_t("second", registry));
+
+        auto samples = registry.snapshot();
+        REQUIRE(samples.size() == 2);
+        CHECK(samples[0].name == "first");
+        CHECK(samples[1].name == "second");
+
+        signal2.reset();
+        samples = registry.snapshot();
+        REQUIRE(samples.size() == 1);
+        CHECK(samples[0].name == "first");
+    }
+
+    CHECK(registry.snapshot().empty());
+}
+
+TEST_CASE("sig11/signal_registry/process_wide_instance")
+{
+    const std::size_t before = sig11::signal_registry::instance().snapshot().size();
+    {
+        signal_t signal("global");
+        CHECK(sig11::signal_registry::instance().snapshot().size() == before + 1);
+    }
+    CHECK(sig11::signal_registry::instance().snapshot().size() == before);
+}
+
+TEST_CASE("sig11/metrics_tracer/counters")
+{
+    sig11::signal_registry registry;
+    signal_t signal("counted", registry);
+
+    sig11::connection conn1(signal.connect([](int){}));
+    sig11::connection conn2(signal.connect([](int){ std::this_thread::sleep_for(std::chrono::milliseconds(1)); }));
+    signal(1);
+    signal(2);
+    signal.disconnect(conn1);
+    signal(3);
+
+    const sig11::signal_metrics &metrics = signal.tracer().metrics();
+    CHECK(metrics.name() == "counted");
+    CHECK(metrics.listeners() == 1);
+    CHECK(metrics.emits() == 3);
+    CHECK(metrics.slot_time() >= std::chrono::milliseconds(3));
+
+    auto samples = registry.snapshot();
+    REQUIRE(samples.size() == 1);
+    CHECK(samples[0].listeners == 1);
+    CHECK(samples[0].emits == 3);
+}
+
+TEST_CASE("sig11/metrics_tracer/throwing_receiver")
+{
+    sig11::signal_registry registry;
+    signal_t signal("throwing", registry);
+
+    signal.connect([](int value){
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (value < 0) {
+            throw std::runtime_error("failed");
+        }
+    });
+
+    CHECK_THROWS_AS(signal(-1), std::runtime_error);
+    const std::chrono::nanoseconds before = signal.tracer().metrics().slot_time();
+    signal(1);
+
+    // the aborted emission must not stop the time accounting
+    CHECK(signal.tracer().metrics().slot_time() - before >= std::chrono::milliseconds(1));
+    CHECK(signal.tracer().metrics().emits() == 2);
+}
+
+TEST_CASE("sig11/metrics_tracer/nested_time_counted_once")
+{
+    sig11::signal_registry registry;
+    signal_t signal("nested", registry);
+
+    signal.connect([&signal](int depth){
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        if (depth > 0) {
+            signal(depth - 1);
+        }
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    signal(2);
+    const auto wall = std::chrono::steady_clock::now() - start;
+
+    const std::chrono::nanoseconds slot_time = signal.tracer().metrics().slot_time();
+    CHECK(slot_time >= std::chrono::milliseconds(6));
+    CHECK(slot_time <= wall);
+}
+
+TEST_CASE("sig11/signal_registry/prometheus_export")
+{
+    sig11::signal_registry registry;
+    signal_t signal("orders \"filled\"", registry);
+    signal.connect([](int){});
+    signal(1);
+
+    const std::string text = registry.to_prometheus();
+    CHECK(text.find("# TYPE sig11_signal_listeners gauge\n") != std::string::npos);
+    CHECK(text.find("sig11_signal_listeners{signal=\"orders \\\"filled\\\"\"} 1\n") != std::string::npos);
+    CHECK(text.find("# TYPE sig11_signal_emits_total counter\n") != std::string::npos);
+    CHECK(text.find("sig11_signal_emits_total{signal=\"orders \\\"filled\\\"\"} 1\n") != std::string::npos);
+    CHECK(text.find("sig11_signal_slot_seconds_total{signal=\"orders \\\"filled\\\"\"} ") != std::string::npos);
+}
+
+TEST_CASE("sig11/signal_registry/prometheus_precision")
+{
+    sig11::signal_registry registry;
+    sig11::signal_metrics metrics("slow");
+    // would be rounded to 1234.57 with the default precision
+    metrics.add_slot_time(std::chrono::nanoseconds(1234567890100));
+    registry.register_signal(metrics);
+
+    const std::string text = registry.to_prometheus();
+    registry.unregister_signal(metrics);
+    INFO(text);
+    CHECK(text.find("sig11_signal_slot_seconds_total{signal=\"slow\"} 1234.5678901") != std::string::npos);
+}
+
+TEST_CASE("sig11/signal_registry/duplicate_names")
+{
+    sig11::signal_registry registry;
+    std::unique_ptr<signal_t> first(new signal_t("dup", registry));
+    signal_t second("dup", registry);
+    signal_t other("other", registry);
+
+    auto samples = registry.snapshot();
+    REQUIRE(samples.size() == 3);
+    CHECK(samples[0].index == 0);
+    CHECK(samples[1].index == 1);
+    CHECK(samples[2].index == 0);
+
+    std::string text = registry.to_prometheus();
+    CHECK(text.find("sig11_signal_emits_total{signal=\"dup\"} 0\n") != std::string::npos);
+    CHECK(text.find("sig11_signal_emits_total{signal=\"dup\",index=\"1\"} 0\n") != std::string::npos);
+    CHECK(text.find("sig11_signal_emits_total{signal=\"other\"} 0\n") != std::string::npos);
+    CHECK(registry.to_json().find("{\"name\":\"dup\",\"index\":1,") != std::string::npos);
+
+    // the freed index is reused, so no two signals share one
+    first.reset();
+    signal_t third("dup", registry);
+    samples = registry.snapshot();
+    REQUIRE(samples.size() == 3);
+    CHECK(samples[0].index == 1);
+    CHECK(samples[2].index == 0);
+}
+
+TEST_CASE("sig11/signal_registry/json_export")
+{
+    sig11::signal_registry registry;
+    CHECK(registry.to_json() == "[]\n");
+
+    signal_t signal1("a\\b", registry);
+    signal_t signal2("c", registry);
+    signal1.connect([](int){});
+    signal2(1);
+    signal2(2);
+
+    const std::string text = registry.to_json();
+    CHECK(text.find("{\"name\":\"a\\\\b\",\"listeners\":1,\"emits\":0,\"slot_time_ns\":0}") != std::string::npos);
+    CHECK(text.find("{\"name\":\"c\",\"listeners\":0,\"emits\":2,\"slot_time_ns\":") != std::string::npos);
+}
+
+TEST_CASE("sig11/signal_registry/write_file")
+{
+    sig11::signal_registry registry;
+    signal_t signal("file", registry);
+
+    const std::string path = "sig11_registry_test.json";
+    REQUIRE(registry.write_json_file(path));
+
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    CHECK(contents.str() == registry.to_json());
+    std::remove(path.c_str());
+
+    CHECK_FALSE(registry.write_prometheus_file("/nonexistent/dir/metrics.prom"));
+}
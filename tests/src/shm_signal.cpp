@@ -0,0 +1,172 @@
+/**********************************************************************
+File name: shm_signal.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/shm_signal.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+struct sample
+{
+    int id;
+    double value;
+};
+
+
+static std::string unique_name(const char *suffix)
+{
+    return "/sig11-test-" + std::to_string(::getpid()) + "-" + suffix;
+}
+
+
+TEST_CASE("sig11/shm_signal/emit_and_dispatch")
+{
+    const std::string name(unique_name("basic"));
+    sig11::shm_signal<void(int, sample)> signal(name, 8);
+    sig11::shm_subscriber<void(int, sample)> subscriber(name);
+
+    std::vector<int> ids;
+    subscriber.target().connect([&ids](int seq, sample s){
+        ids.push_back(seq * 100 + s.id);
+    });
+
+    signal(1, sample{2, 0.5});
+    signal(3, sample{4, 0.5});
+    CHECK(ids.empty());
+
+    CHECK(subscriber.wait(std::chrono::milliseconds(0)));
+    CHECK(subscriber.dispatch() == 2);
+    CHECK(ids == std::vector<int>({102, 304}));
+    CHECK(subscriber.dispatch() == 0);
+    CHECK(subscriber.lost() == 0);
+}
+
+TEST_CASE("sig11/shm_signal/slow_subscriber_loses_oldest")
+{
+    const std::string name(unique_name("lossy"));
+    sig11::shm_signal<void(int)> signal(name, 4);
+    sig11::shm_subscriber<void(int)> subscriber(name);
+
+    std::vector<int> received;
+    subscriber.target().connect([&received](int value){ received.push_back(value); });
+
+    for (int i = 0; i < 10; ++i) {
+        signal(i);
+    }
+    CHECK(subscriber.dispatch() == 4);
+    CHECK(received == std::vector<int>({6, 7, 8, 9}));
+    CHECK(subscriber.lost() == 6);
+}
+
+TEST_CASE("sig11/shm_signal/rejects_mismatching_layout")
+{
+    const std::string name(unique_name("mismatch"));
+    sig11::shm_signal<void(int)> signal(name, 4);
+    CHECK_THROWS_AS(sig11::shm_subscriber<void(double)>(name), std::runtime_error);
+    CHECK_THROWS_AS(sig11::shm_subscriber<void(int)>(unique_name("missing")),
+                    std::system_error);
+}
+
+TEST_CASE("sig11/shm_signal/replacing_keeps_old_mapping")
+{
+    const std::string name(unique_name("replace"));
+    std::unique_ptr<sig11::shm_signal<void(int)> > old_signal(
+                new sig11::shm_signal<void(int)>(name, 4));
+    sig11::shm_subscriber<void(int)> old_subscriber(name);
+
+    std::vector<int> old_received;
+    old_subscriber.target().connect([&old_received](int value){ old_received.push_back(value); });
+
+    // a larger ring under the same name must not truncate the old one
+    sig11::shm_signal<void(int)> signal(name, 64);
+    sig11::shm_subscriber<void(int)> subscriber(name);
+    std::vector<int> received;
+    subscriber.target().connect([&received](int value){ received.push_back(value); });
+
+    (*old_signal)(1);
+    signal(2);
+    CHECK(old_subscriber.dispatch() == 1);
+    CHECK(subscriber.dispatch() == 1);
+    CHECK(old_received == std::vector<int>({1}));
+    CHECK(received == std::vector<int>({2}));
+
+    // the old signal must not unlink the name of the new one
+    old_signal.reset();
+    sig11::shm_subscriber<void(int)> late(name);
+    signal(3);
+    CHECK(late.dispatch() == 1);
+    CHECK(subscriber.dispatch() == 1);
+}
+
+TEST_CASE("sig11/shm_signal/cross_process")
+{
+    static const int emits = 1000;
+
+    const std::string name(unique_name("fork"));
+    sig11::shm_signal<void(int)> signal(name, 2048);
+    sig11::shm_subscriber<void(int)> subscriber(name);
+
+    std::vector<int> received;
+    subscriber.target().connect([&received](int value){ received.push_back(value); });
+
+    const pid_t child = ::fork();
+    REQUIRE(child >= 0);
+    if (child == 0) {
+        // the mapping is shared with the parent
+        ::usleep(10000);
+        for (int i = 0; i < emits; ++i) {
+            signal(i);
+        }
+        ::_exit(0);
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (received.size() < static_cast<std::size_t>(emits) &&
+           std::chrono::steady_clock::now() < deadline)
+    {
+        if (subscriber.wait(std::chrono::milliseconds(100))) {
+            subscriber.dispatch();
+        }
+    }
+
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    CHECK(WIFEXITED(status));
+
+    REQUIRE(received.size() == static_cast<std::size_t>(emits));
+    bool in_order = true;
+    for (int i = 0; i < emits; ++i) {
+        in_order = in_order && received[i] == i;
+    }
+    CHECK(in_order);
+    CHECK(subscriber.lost() == 0);
+}
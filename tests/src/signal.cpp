@@ -25,6 +25,8 @@ in the AUTHORS file.
 
 #include "sig11/sig11.hpp"
 
+#include "alloc_counter.hpp"
+
 #include <condition_variable>
 #include <thread>
 
@@ -108,6 +110,148 @@ TEST_CASE("sig11/signal/disconnect_during_emit")
 }
 
 
+TEST_CASE("sig11/signal/recursive_emit")
+{
+    sig11::signal<void(int)> signal;
+    std::vector<std::pair<int, int> > values;
+
+    signal.connect([&values, &signal](int value){
+        values.emplace_back(0, value);
+        if (value > 0) {
+            signal(value - 1);
+        }
+    });
+    signal.connect([&values](int value){ values.emplace_back(1, value); });
+
+    signal(2);
+
+    std::vector<std::pair<int, int> > reference({{0, 2}, {0, 1}, {0, 0}, {1, 0}, {1, 1}, {1, 2}});
+    CHECK(values == reference);
+}
+
+TEST_CASE("sig11/signal/recursive_emit_disconnect")
+{
+    sig11::signal<void(int)> signal;
+    sig11::connection conn;
+    std::vector<std::pair<int, int> > values;
+
+    signal.connect([&values, &signal, &conn](int value){
+        values.emplace_back(0, value);
+        if (value > 0) {
+            signal(value - 1);
+        } else {
+            signal.disconnect(conn);
+        }
+    });
+    conn = signal.connect([&values](int value){ values.emplace_back(1, value); });
+
+    signal(1);
+    signal(0);
+
+    std::vector<std::pair<int, int> > reference({{0, 1}, {0, 0}, {0, 0}});
+    CHECK(values == reference);
+    CHECK_FALSE(conn);
+}
+
+TEST_CASE("sig11/signal/recursive_emit_reuses_buffers")
+{
+    sig11::signal<void(int)> signal;
+    int calls = 0;
+
+    signal.connect([&calls, &signal](int value){
+        ++calls;
+        if (value > 0) {
+            signal(value - 1);
+        }
+    });
+
+    // warm up the dispatch buffers of all depths
+    signal(3);
+
+    sig11::alloc_counter counter;
+    signal(3);
+    signal(1);
+    CHECK(counter.allocations() == 0);
+    CHECK(calls == 10);
+}
+
+
+TEST_CASE("sig11/signal/empty")
+{
+    sig11::signal<void(int)> signal;
+    CHECK(signal.empty());
+
+    sig11::connection conn(signal.connect([](int){}));
+    signal.connect_once([](int){});
+    CHECK_FALSE(signal.empty());
+
+    signal.disconnect(conn);
+    CHECK_FALSE(signal.empty());
+    // the one-shot receiver is retired by the emission
+    signal(1);
+    CHECK(signal.empty());
+}
+
+TEST_CASE("sig11/signal/emit_reports_dispatch")
+{
+    sig11::signal<void(int)> signal;
+    CHECK_FALSE(signal.emit(1));
+
+    sig11::connection conn(signal.connect([](int){}));
+    signal.connect_once([](int){});
+    CHECK(signal.emit(2));
+
+    signal.disconnect(conn);
+    CHECK_FALSE(signal.emit(3));
+}
+
+TEST_CASE("sig11/signal/connect_once")
+{
+    sig11::signal<void(int)> signal;
+    std::vector<std::pair<int, int> > values;
+
+    signal.connect([&values](int value){ values.emplace_back(0, value); });
+    sig11::connection conn(signal.connect_once([&values](int value){ values.emplace_back(1, value); }));
+    CHECK(conn);
+
+    signal(10);
+    signal(20);
+
+    std::vector<std::pair<int, int> > reference({{0, 10}, {1, 10}, {0, 20}});
+    CHECK(values == reference);
+
+    // disconnecting a fired one-shot receiver is a no-op
+    signal.disconnect(conn);
+}
+
+TEST_CASE("sig11/signal/connect_once_disconnect_before_emit")
+{
+    sig11::signal<void(int)> signal;
+    int calls = 0;
+
+    sig11::connection conn(signal.connect_once([&calls](int){ ++calls; }));
+    signal.disconnect(conn);
+    CHECK_FALSE(conn);
+    signal(10);
+    CHECK(calls == 0);
+}
+
+TEST_CASE("sig11/signal/connect_once_recursive_emit")
+{
+    sig11::signal<void(int)> signal;
+    int calls = 0;
+
+    signal.connect_once([&calls, &signal](int value){
+        ++calls;
+        signal(value + 1);
+    });
+
+    signal(0);
+    signal(0);
+    CHECK(calls == 1);
+}
+
+
 class ThreadTesterConnectEmit
 {
 public:
@@ -289,3 +433,74 @@ TEST_CASE("sig11/connect")
     signal(10);
     CHECK(destination == 10);
 }
+
+TEST_CASE("sig11/signal/connect_once_overlapping_emits")
+{
+    static const int receivers = 200;
+
+    // every receiver emits recursively, so that each of the later one-shot
+    // receivers is contended by all the emissions which are in progress
+    sig11::signal<void()> signal;
+    std::vector<int> calls(receivers, 0);
+
+    for (int i = 0; i < receivers; ++i) {
+        signal.connect_once([&calls, &signal, i](){
+            calls[i] += 1;
+            signal();
+        });
+    }
+
+    signal();
+    signal();
+
+    CHECK(calls == std::vector<int>(receivers, 1));
+}
+
+TEST_CASE("sig11/signal/forward")
+{
+    sig11::signal<void(int)> a;
+    sig11::signal<void(int)> b;
+    sig11::signal<void(int), sig11::null_tracer, sig11::null_mutex> c;
+    std::vector<int> received;
+
+    sig11::connection conn(a.forward(b));
+    auto guard(sig11::forward(b, c));
+    b.connect([&received](int value){ received.push_back(value); });
+    c.connect([&received](int value){ received.push_back(-value); });
+
+    // b forwards to c before calling its own receiver
+    a(1);
+    CHECK(received == std::vector<int>({-1, 1}));
+
+    // receivers connected to the target later are reached as well
+    c.connect([&received](int value){ received.push_back(value * 10); });
+    received.clear();
+    a(2);
+    CHECK(received == std::vector<int>({-2, 20, 2}));
+
+    a.disconnect(conn);
+    received.clear();
+    a(3);
+    CHECK(received.empty());
+
+    guard.disconnect();
+    b(4);
+    CHECK(received == std::vector<int>({4}));
+}
+
+TEST_CASE("sig11/signal/forward_does_not_allocate")
+{
+    sig11::signal<void(int)> a;
+    sig11::signal<void(int)> b;
+    int sum = 0;
+
+    a.forward(b);
+    b.connect([&sum](int value){ sum += value; });
+    a(1);
+
+    sig11::alloc_counter counter;
+    a(2);
+    a(3);
+    CHECK(counter.allocations() == 0);
+    CHECK(sum == 6);
+}
@@ -0,0 +1,158 @@
+/**********************************************************************
+File name: static_signal.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/sig11.hpp"
+#include "sig11/static_signal.hpp"
+
+#include <vector>
+
+
+static std::vector<std::pair<int, int> > static_log;
+
+static void record_static(int value)
+{
+    static_log.emplace_back(0, value);
+}
+
+struct record_one
+{
+    void operator()(int value) const
+    {
+        static_log.emplace_back(1, value);
+    }
+};
+
+struct record_two
+{
+    void operator()(int value) const
+    {
+        static_log.emplace_back(2, value);
+    }
+};
+
+struct scale
+{
+    constexpr scale(int factor):
+        factor(factor)
+    {
+
+    }
+
+    int factor;
+
+    void operator()(int value) const
+    {
+        static_log.emplace_back(3, value * factor);
+    }
+};
+
+
+TEST_CASE("sig11/static_signal/template_receivers")
+{
+    static_log.clear();
+    sig11::static_signal<void(int),
+                         sig11::static_fn<decltype(&record_static), &record_static>,
+                         record_one,
+                         record_two> signal;
+    CHECK(signal.size() == 3);
+    static_assert(sizeof(signal) == 1,
+                  "stateless receivers must not take up space");
+
+    signal(10);
+    signal(20);
+
+    std::vector<std::pair<int, int> > reference({{0, 10}, {1, 10}, {2, 10}, {0, 20}, {1, 20}, {2, 20}});
+    CHECK(static_log == reference);
+}
+
+TEST_CASE("sig11/static_signal/constexpr_builder")
+{
+    static_log.clear();
+    static constexpr auto signal = sig11::static_signal<void(int)>()
+            .connect(record_one())
+            .connect(scale(3));
+    static_assert(signal.size() == 2, "builder must append receivers");
+    static_assert(signal.receiver<1>().factor == 3, "builder must keep receiver state");
+
+    signal(10);
+
+    std::vector<std::pair<int, int> > reference({{1, 10}, {3, 30}});
+    CHECK(static_log == reference);
+}
+
+TEST_CASE("sig11/static_signal/make_static_signal")
+{
+    std::vector<int> values;
+
+    auto signal = sig11::make_static_signal<void(int)>(
+                [&values](int value){ values.push_back(value); },
+                [&values](int value){ values.push_back(-value); });
+    signal(10);
+
+    std::vector<int> reference({10, -10});
+    CHECK(values == reference);
+}
+
+TEST_CASE("sig11/static_signal/copy_single_receiver")
+{
+    static_log.clear();
+    auto signal = sig11::make_static_signal<void(int)>(scale(2));
+    // a non-const lvalue must pick the copy constructor, not the receiver
+    // constructor
+    decltype(signal) copy(signal);
+    const decltype(signal) const_copy(copy);
+    decltype(signal) moved(std::move(copy));
+
+    const_copy(5);
+    moved(6);
+
+    std::vector<std::pair<int, int> > reference({{3, 10}, {3, 12}});
+    CHECK(static_log == reference);
+}
+
+template <typename signal_t>
+static void emit_twice(signal_t &signal, int value)
+{
+    signal(value);
+    signal(value + 1);
+}
+
+TEST_CASE("sig11/static_signal/drop_in_for_signal")
+{
+    static_log.clear();
+    sig11::signal<void(int)> dynamic_signal;
+    sig11::static_signal<void(int), record_one> static_signal;
+    auto guard(sig11::connect(dynamic_signal, record_one()));
+
+    static_assert(std::is_same<decltype(dynamic_signal)::call_t,
+                               decltype(static_signal)::call_t>::value,
+                  "call_t must match");
+
+    emit_twice(dynamic_signal, 10);
+    emit_twice(static_signal, 10);
+
+    std::vector<std::pair<int, int> > reference({{1, 10}, {1, 11}, {1, 10}, {1, 11}});
+    CHECK(static_log == reference);
+}
@@ -0,0 +1,190 @@
+/**********************************************************************
+File name: timer_wheel.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/timer_wheel.hpp"
+
+#include <chrono>
+#include <vector>
+
+
+using namespace std::chrono_literals;
+
+
+namespace {
+
+struct fire_log
+{
+    std::vector<int> fired;
+};
+
+struct timer_context
+{
+    fire_log *log;
+    int id;
+};
+
+void record_fire(void *context)
+{
+    timer_context *ctx = static_cast<timer_context*>(context);
+    ctx->log->fired.push_back(ctx->id);
+}
+
+}
+
+
+TEST_CASE("sig11/timer_wheel/fires_in_deadline_order")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    sig11::timer_wheel wheel(1ms, start);
+    fire_log log;
+    timer_context a{&log, 1}, b{&log, 2}, c{&log, 3};
+
+    wheel.schedule_at(start + 30ms, &record_fire, &c);
+    wheel.schedule_at(start + 10ms, &record_fire, &a);
+    wheel.schedule_after(20ms, &record_fire, &b);
+    CHECK(wheel.size() == 3);
+
+    CHECK(wheel.advance(start + 9ms) == 0);
+    CHECK(wheel.advance(start + 10ms) == 1);
+    CHECK(log.fired == std::vector<int>({1}));
+    CHECK(wheel.now() == start + 10ms);
+
+    CHECK(wheel.advance(start + 100ms) == 2);
+    CHECK(log.fired == std::vector<int>({1, 2, 3}));
+    CHECK(wheel.size() == 0);
+}
+
+TEST_CASE("sig11/timer_wheel/cascades_from_higher_levels")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    sig11::timer_wheel wheel(1ms, start);
+    fire_log log;
+    // one timer per level, plus one beyond the top level
+    std::vector<timer_context> contexts;
+    const std::vector<std::chrono::milliseconds> delays{
+        5ms, 100ms, 5000ms, 300000ms, 20000000ms
+    };
+    for (std::size_t i = 0; i < delays.size(); ++i) {
+        contexts.push_back(timer_context{&log, static_cast<int>(i)});
+    }
+    for (std::size_t i = 0; i < delays.size(); ++i) {
+        wheel.schedule_at(start + delays[i], &record_fire, &contexts[i]);
+    }
+
+    for (std::size_t i = 0; i < delays.size(); ++i) {
+        CHECK(wheel.advance(start + delays[i] - 1ms) == 0);
+        CHECK(wheel.advance(start + delays[i]) == 1);
+        CHECK(log.fired.size() == i + 1);
+    }
+    CHECK(log.fired == std::vector<int>({0, 1, 2, 3, 4}));
+}
+
+TEST_CASE("sig11/timer_wheel/cancel")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    sig11::timer_wheel wheel(1ms, start);
+    fire_log log;
+    timer_context a{&log, 1}, b{&log, 2};
+
+    sig11::timer_handle ha = wheel.schedule_after(10ms, &record_fire, &a);
+    sig11::timer_handle hb = wheel.schedule_after(10000ms, &record_fire, &b);
+    CHECK(ha != hb);
+
+    CHECK(wheel.cancel(hb));
+    CHECK_FALSE(wheel.cancel(hb));
+    CHECK_FALSE(wheel.cancel(sig11::timer_handle()));
+    CHECK(wheel.size() == 1);
+
+    wheel.advance(start + 20000ms);
+    CHECK(log.fired == std::vector<int>({1}));
+    // fired timers cannot be cancelled, and their slot is reused with a
+    // new generation
+    CHECK_FALSE(wheel.cancel(ha));
+    sig11::timer_handle hc = wheel.schedule_after(1ms, &record_fire, &a);
+    CHECK(hc.index() == ha.index());
+    CHECK_FALSE(wheel.cancel(ha));
+    CHECK(wheel.cancel(hc));
+}
+
+TEST_CASE("sig11/timer_wheel/callbacks_reschedule")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    sig11::timer_wheel wheel(1ms, start);
+
+    struct periodic
+    {
+        sig11::timer_wheel *wheel;
+        int count;
+
+        static void fire(void *context)
+        {
+            periodic *self = static_cast<periodic*>(context);
+            if (++self->count < 5) {
+                self->wheel->schedule_after(10ms, &periodic::fire, self);
+            }
+        }
+    };
+
+    periodic timer{&wheel, 0};
+    wheel.schedule_after(10ms, &periodic::fire, &timer);
+    CHECK(wheel.advance(start + 35ms) == 3);
+    CHECK(timer.count == 3);
+    CHECK(wheel.advance(start + 1000ms) == 2);
+    CHECK(timer.count == 5);
+    CHECK(wheel.size() == 0);
+}
+
+TEST_CASE("sig11/timer_wheel/past_deadlines_fire_on_next_tick")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    sig11::timer_wheel wheel(1ms, start);
+    fire_log log;
+    timer_context a{&log, 1};
+
+    wheel.advance(start + 50ms);
+    wheel.schedule_at(start, &record_fire, &a);
+    CHECK(wheel.advance(start + 50ms) == 0);
+    CHECK(wheel.advance(start + 51ms) == 1);
+}
+
+TEST_CASE("sig11/timer_wheel/long_gap")
+{
+    const auto start = sig11::timer_wheel::clock::now();
+    sig11::timer_wheel wheel(1ms, start);
+    fire_log log;
+    timer_context a{&log, 1}, b{&log, 2}, c{&log, 3};
+
+    // far beyond the top level, so that the overflow cascades many times
+    wheel.schedule_at(start + 2000h, &record_fire, &c);
+    wheel.schedule_at(start + 70ms, &record_fire, &a);
+    wheel.schedule_at(start + 1000h + 1ms, &record_fire, &b);
+
+    CHECK(wheel.advance(start + 1000h) == 1);
+    CHECK(log.fired == std::vector<int>({1}));
+    CHECK(wheel.now() == start + 1000h);
+    CHECK(wheel.advance(start + 2000h - 1ms) == 1);
+    CHECK(wheel.advance(start + 2000h) == 1);
+    CHECK(log.fired == std::vector<int>({1, 2, 3}));
+}
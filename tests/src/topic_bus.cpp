@@ -0,0 +1,152 @@
+/**********************************************************************
+File name: topic_bus.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/topic_bus.hpp"
+
+#include "alloc_counter.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+TEST_CASE("sig11/topic_bus/wildcards")
+{
+    sig11::topic_bus<void(int)> bus;
+    std::vector<std::string> received;
+
+    auto subscriber = [&received](const std::string &name){
+        return [&received, name](int value){
+            received.push_back(name + ":" + std::to_string(value));
+        };
+    };
+
+    auto exact(bus.subscribe("orders/eu/filled", subscriber("exact")));
+    auto star(bus.subscribe("orders/*/filled", subscriber("star")));
+    auto hash(bus.subscribe("orders/#", subscriber("hash")));
+    auto all(bus.subscribe("#", subscriber("all")));
+    auto md(bus.subscribe("md/*", subscriber("md")));
+
+    auto publish = [&bus, &received](const std::string &topic, int value){
+        received.clear();
+        bus.publish(topic, value);
+        std::sort(received.begin(), received.end());
+        return received;
+    };
+
+    CHECK(publish("orders/eu/filled", 1) ==
+          std::vector<std::string>({"all:1", "exact:1", "hash:1", "star:1"}));
+    CHECK(publish("orders/us/filled", 2) ==
+          std::vector<std::string>({"all:2", "hash:2", "star:2"}));
+    CHECK(publish("orders/us/cancelled", 3) ==
+          std::vector<std::string>({"all:3", "hash:3"}));
+    // # also matches the parent level itself
+    CHECK(publish("orders", 4) ==
+          std::vector<std::string>({"all:4", "hash:4"}));
+    CHECK(publish("md/aapl", 5) ==
+          std::vector<std::string>({"all:5", "md:5"}));
+    CHECK(publish("md/aapl/trade", 6) ==
+          std::vector<std::string>({"all:6"}));
+    CHECK(publish("md", 7) ==
+          std::vector<std::string>({"all:7"}));
+
+    // orders/eu only exists in the trie as a prefix of orders/eu/filled
+    CHECK(bus.publish("orders/eu", 8) == 2);
+}
+
+TEST_CASE("sig11/topic_bus/unsubscribe_with_guard")
+{
+    sig11::topic_bus<void(int)> bus;
+    int calls = 0;
+
+    {
+        auto guard(bus.subscribe("a/*", [&calls](int){ ++calls; }));
+        bus.publish("a/b", 0);
+        CHECK(calls == 1);
+    }
+    // the pattern stays in the trie, but has no receivers anymore
+    CHECK(bus.publish("a/b", 0) == 0);
+    CHECK(calls == 1);
+
+    sig11::connection conn(bus.topic("a/*").connect([&calls](int){ ++calls; }));
+    bus.publish("a/c", 0);
+    CHECK(calls == 2);
+    bus.topic("a/*").disconnect(conn);
+    bus.publish("a/c", 0);
+    CHECK(calls == 2);
+}
+
+TEST_CASE("sig11/topic_bus/malformed_patterns")
+{
+    sig11::topic_bus<void()> bus;
+    CHECK_THROWS_AS(bus.topic("a/#/b"), std::invalid_argument);
+    CHECK_THROWS_AS(bus.topic("a/b*"), std::invalid_argument);
+    CHECK_THROWS_AS(bus.topic("a/#b"), std::invalid_argument);
+    CHECK_NOTHROW(bus.topic("a/*/b/#"));
+}
+
+TEST_CASE("sig11/topic_bus/recursive_publish")
+{
+    sig11::topic_bus<void(int)> bus;
+    std::vector<int> received;
+
+    auto forward(bus.subscribe("in/*", [&bus](int value){
+        bus.publish("out/x", value * 10);
+    }));
+    auto sink(bus.subscribe("out/#", [&received](int value){
+        received.push_back(value);
+    }));
+
+    bus.publish("in/a", 1);
+    bus.publish("in/b", 2);
+    CHECK(received == std::vector<int>({10, 20}));
+}
+
+TEST_CASE("sig11/topic_bus/publish_does_not_allocate")
+{
+    sig11::topic_bus<void(int)> bus;
+    int sum = 0;
+    auto a(bus.subscribe("prices/*/last", [&sum](int value){ sum += value; }));
+    auto b(bus.subscribe("prices/#", [&sum](int value){ sum += value; }));
+    bus.publish("prices/a-very-long-instrument-name/last", 1);
+
+    const std::string last("prices/another-very-long-instrument-name/last");
+    const std::string other("prices/x");
+    sig11::alloc_counter counter;
+    bus.publish(last, 2);
+    bus.publish(other, 3);
+    CHECK(counter.allocations() == 0);
+    CHECK(sum == 2 + 4 + 3);
+}
+
+TEST_CASE("sig11/topic_bus/construction_does_not_allocate")
+{
+    sig11::alloc_counter counter;
+    {
+        sig11::topic_bus<void(int)> bus;
+    }
+    CHECK(counter.allocations() == 0);
+}
@@ -0,0 +1,191 @@
+/**********************************************************************
+File name: tracer.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/sig11.hpp"
+
+#include <string>
+#include <vector>
+
+
+class recording_tracer
+{
+public:
+    struct slot_state
+    {
+        slot_state():
+            calls(0)
+        {
+
+        }
+
+        int calls;
+    };
+
+public:
+    explicit recording_tracer(std::vector<std::string> &log):
+        m_log(log)
+    {
+
+    }
+
+private:
+    std::vector<std::string> &m_log;
+
+public:
+    void on_connect(sig11::token_id id, slot_state&)
+    {
+        m_log.push_back("connect " + std::to_string(id));
+    }
+
+    void on_disconnect(sig11::token_id id, slot_state &state)
+    {
+        m_log.push_back("disconnect " + std::to_string(id) + " after " + std::to_string(state.calls));
+    }
+
+    void on_emit_begin()
+    {
+        m_log.push_back("emit_begin");
+    }
+
+    void on_slot_begin(sig11::token_id id, slot_state &state)
+    {
+        state.calls += 1;
+        m_log.push_back("slot_begin " + std::to_string(id));
+    }
+
+    void on_slot_end(sig11::token_id id, slot_state&)
+    {
+        m_log.push_back("slot_end " + std::to_string(id));
+    }
+
+    void on_emit_end()
+    {
+        m_log.push_back("emit_end");
+    }
+
+};
+
+
+TEST_CASE("sig11/tracer/hooks")
+{
+    std::vector<std::string> log;
+    sig11::signal<void(int), recording_tracer> signal(log);
+
+    auto fun = [&log](int value){ log.push_back("value " + std::to_string(value)); };
+
+    sig11::connection conn1(signal.connect(fun));
+    sig11::connection conn2(signal.connect(fun));
+    signal(10);
+    signal.disconnect(conn1);
+    signal(20);
+    signal.disconnect(conn2);
+    signal(30);
+
+    std::vector<std::string> reference({
+        "connect 0",
+        "connect 1",
+        "emit_begin",
+        "slot_begin 0", "value 10", "slot_end 0",
+        "slot_begin 1", "value 10", "slot_end 1",
+        "emit_end",
+        "disconnect 0 after 1",
+        "emit_begin",
+        "slot_begin 1", "value 20", "slot_end 1",
+        "emit_end",
+        "disconnect 1 after 2",
+        "emit_begin",
+        "emit_end",
+    });
+    CHECK(log == reference);
+}
+
+TEST_CASE("sig11/tracer/disconnect_during_emit_keeps_slot_state")
+{
+    std::vector<std::string> log;
+    sig11::signal<void(int), recording_tracer> signal(log);
+    sig11::connection conn;
+
+    auto fun = [&conn, &signal](int){ signal.disconnect(conn); };
+    conn = signal.connect(fun);
+    signal(10);
+    CHECK_FALSE(conn);
+
+    std::vector<std::string> reference({
+        "connect 0",
+        "emit_begin",
+        "slot_begin 0", "disconnect 0 after 1", "slot_end 0",
+        "emit_end",
+    });
+    CHECK(log == reference);
+}
+
+TEST_CASE("sig11/tracer/disconnect_later_slot_during_emit")
+{
+    sig11::signal<void(int)> signal;
+    sig11::connection conn;
+    std::vector<int> values;
+
+    auto fun1 = [&conn, &signal, &values](int value){ values.push_back(value); signal.disconnect(conn); };
+    auto fun2 = [&values](int value){ values.push_back(-value); };
+
+    signal.connect(fun1);
+    conn = signal.connect(fun2);
+    signal(10);
+    signal(20);
+
+    std::vector<int> reference({10, 20});
+    CHECK(values == reference);
+}
+
+TEST_CASE("sig11/tracer/connect_with_tracer")
+{
+    std::vector<std::string> log;
+    sig11::signal<void(int), recording_tracer> signal(log);
+    int destination = 0;
+
+    {
+        auto guard(sig11::connect(signal, [&destination](int value){ destination = value; }));
+        signal(10);
+    }
+
+    CHECK(destination == 10);
+    CHECK(log.back() == "disconnect 0 after 1");
+}
+
+TEST_CASE("sig11/tracer/arena_and_tracer")
+{
+    std::vector<std::string> log;
+    sig11::slot_arena arena;
+
+    {
+        sig11::signal<void(int), recording_tracer> signal(arena, log);
+        signal.connect([](int){});
+        // the listener and the receiver list
+        CHECK(arena.blocks_in_use() == 2);
+    }
+
+    CHECK(arena.blocks_in_use() == 0);
+    CHECK(log.size() == 1);
+}
@@ -0,0 +1,180 @@
+/**********************************************************************
+File name: wait_free_signal.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/wait_free_signal.hpp"
+
+#include "alloc_counter.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+
+TEST_CASE("sig11/wait_free_signal/connect_emit_disconnect")
+{
+    sig11::wait_free_signal<void(int)> signal;
+    std::vector<std::pair<int, int> > values;
+
+    auto fun1 = [&values](int value){ values.emplace_back(0, value); };
+    auto fun2 = [&values](int value){ values.emplace_back(1, value); };
+    auto fun3 = [&values](int value){ values.emplace_back(2, value); };
+
+    signal.connect(fun1);
+    sig11::connection conn(signal.connect(fun2));
+    signal.connect(fun3);
+    signal(10);
+    signal.disconnect(conn);
+    CHECK_FALSE(conn);
+    signal(20);
+
+    std::vector<std::pair<int, int> > reference({{0, 10}, {1, 10}, {2, 10}, {0, 20}, {2, 20}});
+    CHECK(values == reference);
+}
+
+TEST_CASE("sig11/wait_free_signal/disconnect_during_emit")
+{
+    sig11::wait_free_signal<void(int)> signal;
+    sig11::connection conn;
+    int destination = 0;
+
+    auto fun = [&destination, &conn, &signal](int value){ destination = value; signal.disconnect(conn); };
+
+    conn = signal.connect(fun);
+    signal(10);
+    CHECK(destination == 10);
+    CHECK_FALSE(conn);
+    signal(20);
+    CHECK(destination == 10);
+}
+
+TEST_CASE("sig11/wait_free_signal/connect_during_emit")
+{
+    sig11::wait_free_signal<void(int)> signal;
+    std::vector<int> values;
+    std::vector<sig11::connection> conns;
+
+    auto late = [&values](int value){ values.push_back(-value); };
+    auto fun = [&signal, &conns, late](int){ conns.emplace_back(signal.connect(late)); };
+
+    signal.connect(fun);
+    signal(10);
+    CHECK(values.empty());
+    signal(20);
+
+    std::vector<int> reference({-20});
+    CHECK(values == reference);
+}
+
+TEST_CASE("sig11/wait_free_signal/recursive_emit_disconnects")
+{
+    sig11::wait_free_signal<void(int)> signal;
+    sig11::connection later;
+    std::vector<int> values;
+
+    // the nested emission disconnects a receiver which both emissions have
+    // yet to call; they still use their snapshots
+    signal.connect([&signal](int value){
+        if (value == 1) {
+            signal(2);
+        }
+    });
+    signal.connect([&signal, &later](int value){
+        if (value == 2) {
+            signal.disconnect(later);
+        }
+    });
+    later = signal.connect([&values](int value){ values.push_back(value); });
+
+    signal(1);
+    CHECK_FALSE(later);
+    CHECK(values == std::vector<int>({2, 1}));
+
+    signal(3);
+    CHECK(values == std::vector<int>({2, 1}));
+}
+
+TEST_CASE("sig11/wait_free_signal/connect_guard")
+{
+    sig11::wait_free_signal<void(int)> signal;
+    int destination = 0;
+
+    {
+        auto guard(sig11::connect(signal, [&destination](int value){ destination = value; }));
+        signal(10);
+    }
+    signal(20);
+
+    CHECK(destination == 10);
+}
+
+TEST_CASE("sig11/wait_free_signal/emit_under_writer_load")
+{
+    static const int emits = 20000;
+    static const int writers = 2;
+
+    sig11::wait_free_signal<void(int)> signal;
+    std::atomic<int> persistent_calls(0);
+    std::atomic<int> transient_calls(0);
+    std::atomic<bool> stop(false);
+
+    auto guard(sig11::connect(signal, [&persistent_calls](int){ ++persistent_calls; }));
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < writers; ++i) {
+        threads.emplace_back([&signal, &transient_calls, &stop](){
+            while (!stop.load()) {
+                sig11::connection conn(signal.connect([&transient_calls](int){ ++transient_calls; }));
+                signal.disconnect(conn);
+            }
+        });
+    }
+
+    std::chrono::steady_clock::duration worst(0);
+    std::size_t allocations;
+    {
+        sig11::alloc_counter counter;
+        for (int i = 0; i < emits; ++i) {
+            auto t0 = std::chrono::steady_clock::now();
+            signal(i);
+            auto elapsed = std::chrono::steady_clock::now() - t0;
+            if (elapsed > worst) {
+                worst = elapsed;
+            }
+        }
+        allocations = counter.allocations();
+    }
+
+    stop = true;
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    INFO("worst-case emit latency: "
+         << std::chrono::duration_cast<std::chrono::nanoseconds>(worst).count()
+         << " ns");
+    CHECK(persistent_calls == emits);
+    CHECK(allocations == 0);
+}
@@ -0,0 +1,145 @@
+/**********************************************************************
+File name: watchdog.cpp
+This file is part of: sig11
+
+LICENSE
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program.  If not, see <http://www.gnu.org/licenses/>.
+
+FEEDBACK & QUESTIONS
+
+For feedback and questions about sig11 please e-mail one of the authors named
+in the AUTHORS file.
+**********************************************************************/
+#include <catch.hpp>
+
+#include "sig11/watchdog.hpp"
+
+#include <thread>
+#include <tuple>
+#include <vector>
+
+
+using namespace std::chrono;
+
+
+struct slow_report
+{
+    std::string name;
+    sig11::token_id id;
+    nanoseconds elapsed;
+};
+
+
+TEST_CASE("sig11/watchdog_tracer/reports_slow_slots")
+{
+    std::vector<slow_report> reports;
+    sig11::signal<void(int), sig11::watchdog_tracer> signal(
+                "test.signal", milliseconds(1),
+                [&reports](const std::string &name, sig11::token_id id, nanoseconds elapsed){
+                    reports.push_back(slow_report{name, id, elapsed});
+                });
+
+    sig11::connection fast(signal.connect([](int){}));
+    sig11::connection slow(signal.connect([](int){ std::this_thread::sleep_for(milliseconds(3)); }));
+
+    signal(10);
+
+    REQUIRE(reports.size() == 1);
+    CHECK(reports[0].name == "test.signal");
+    CHECK(reports[0].id == slow.id());
+    CHECK(reports[0].elapsed >= milliseconds(3));
+}
+
+TEST_CASE("sig11/watchdog_tracer/per_connection_budget")
+{
+    std::vector<slow_report> reports;
+    sig11::signal<void(int), sig11::watchdog_tracer> signal(
+                "test.signal", milliseconds(1),
+                [&reports](const std::string &name, sig11::token_id id, nanoseconds elapsed){
+                    reports.push_back(slow_report{name, id, elapsed});
+                });
+
+    auto sleepy = [](int value){ std::this_thread::sleep_for(milliseconds(value)); };
+    sig11::connection tolerant(signal.connect(sleepy));
+    sig11::connection strict(signal.connect(sleepy));
+
+    CHECK(sig11::set_slot_budget(signal, tolerant, seconds(10)));
+    signal(2);
+    REQUIRE(reports.size() == 1);
+    CHECK(reports[0].id == strict.id());
+
+    reports.clear();
+    CHECK(sig11::set_slot_budget(signal, tolerant, nanoseconds(0)));
+    CHECK(sig11::set_slot_budget(signal, strict, seconds(10)));
+    signal(2);
+    REQUIRE(reports.size() == 1);
+    CHECK(reports[0].id == tolerant.id());
+
+    reports.clear();
+    signal.tracer().set_default_budget(nanoseconds(0));
+    signal(2);
+    CHECK(reports.empty());
+
+    signal.disconnect(strict);
+    CHECK_FALSE(sig11::set_slot_budget(signal, strict, seconds(1)));
+}
+
+TEST_CASE("sig11/watchdog_tracer/exempt_connection")
+{
+    std::vector<slow_report> reports;
+    sig11::signal<void(int), sig11::watchdog_tracer> signal(
+                "test.signal", milliseconds(1),
+                [&reports](const std::string &name, sig11::token_id id, nanoseconds elapsed){
+                    reports.push_back(slow_report{name, id, elapsed});
+                });
+
+    auto sleepy = [](int value){ std::this_thread::sleep_for(milliseconds(value)); };
+    sig11::connection exempt(signal.connect(sleepy));
+    sig11::connection checked(signal.connect(sleepy));
+
+    CHECK(sig11::set_slot_budget(signal, exempt, sig11::watchdog_tracer::unlimited()));
+    signal(2);
+    REQUIRE(reports.size() == 1);
+    CHECK(reports[0].id == checked.id());
+
+    // the exemption holds with a stricter default, too
+    reports.clear();
+    signal.tracer().set_default_budget(nanoseconds(1));
+    signal(2);
+    REQUIRE(reports.size() == 1);
+    CHECK(reports[0].id == checked.id());
+}
+
+TEST_CASE("sig11/watchdog_tracer/nested_emit")
+{
+    std::vector<slow_report> reports;
+    sig11::signal<void(int), sig11::watchdog_tracer> signal(
+                "nested", milliseconds(2),
+                [&reports](const std::string &name, sig11::token_id id, nanoseconds elapsed){
+                    reports.push_back(slow_report{name, id, elapsed});
+                });
+
+    sig11::connection outer(signal.connect([&signal](int depth){
+        if (depth > 0) {
+            std::this_thread::sleep_for(milliseconds(3));
+            signal(depth - 1);
+        }
+    }));
+
+    signal(1);
+
+    // the outer call is slow, the nested one is fast
+    REQUIRE(reports.size() == 1);
+    CHECK(reports[0].elapsed >= milliseconds(3));
+}